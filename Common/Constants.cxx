@@ -14,6 +14,7 @@
 
 #include "Constants.hxx"
 #include "Logger.hxx"
+#include "Trace.hxx"
 #include "Utils.hxx"
 #include "config.h"
 #include <cstring>
@@ -24,12 +25,29 @@ namespace Common {
     uint32_t Constants::DRV_NO = 0;                         // Read from PVSS on driver startup
     uint32_t Constants::TSAP_PORT_LOCAL = 0;                // Read from PVSS on driver startup from config file
     uint32_t Constants::TSAP_PORT_REMOTE = 0;               // Read from PVSS on driver startupconfig file
+    uint32_t Constants::PLC_PORT = 102;                     // Read from PVSS on driver startup from config file, default ISO-on-TCP port
     uint32_t Constants::POLLING_INTERVAL = 2;               // Read from PVSS on driver startupconfig file, default 2 seconds
     uint32_t Constants::MSCOPY_PORT = 20248;                // TODO: read from PVSS (or get from Addressing) 
+    uint32_t Constants::FILE_SYNC_POLICY = 1;               // Read from PVSS on driver startup from config file, default fsync files
+    uint32_t Constants::ASYNC_LOG_QUEUE_SIZE = 0;           // Read from PVSS on driver startup from config file, default synchronous logging
+    uint32_t Constants::STATS_INTERVAL = 0;                 // Read from PVSS on driver startup from config file, default no statistics
+    uint32_t Constants::TRACE_EVENTS = 0;                   // Read from PVSS on driver startup from config file, default no tracing
+    std::string Constants::TRACE_PATH = "/tmp/";            // Read from PVSS on driver startup from config file, default /tmp/
+    uint32_t Constants::WARM_STANDBY = 0;                   // Read from PVSS on driver startup from config file, default cold standby
+    uint32_t Constants::CONNECT_TIMEOUT = 0;                // Read from PVSS on driver startup from config file, default snap7 (750 ms)
+    uint32_t Constants::IO_TIMEOUT = 0;                     // Read from PVSS on driver startup from config file, default snap7 (3000 ms receive)
+    std::map<std::string, std::pair<uint32_t, uint32_t>> Constants::PLC_TIMEOUTS;
+    uint32_t Constants::RECONNECT_MAX = 30;                 // Read from PVSS on driver startup from config file, default 30 s
+    std::string Constants::LAST_VALUE_PATH = "";            // Read from PVSS on driver startup from config file, default not kept
+    uint32_t Constants::MIDPOINT_TIMESTAMPS = 0;            // Read from PVSS on driver startup from config file, default response time
+    uint32_t Constants::DELIVERY_QUEUE_SIZE = 0;            // Read from PVSS on driver startup from config file, default unbounded
+    std::string Constants::DELIVERY_OVERFLOW = "dropOldest";// Read from PVSS on driver startup from config file, default dropOldest
+    std::string Constants::JOURNAL_PATH = "/tmp/";          // Read from PVSS on driver startup from config file, default /tmp/
+    uint32_t Constants::BURST_SAMPLES = 4096;               // Read from PVSS on driver startup from config file, default 4096
     std::string Constants::drv_version = PROJECT_VER;
-    std::string MEASUREMENT_PATH = "/opt/ramdev/PVSS_projects/REMUS_TEST/data/mes/in/";
-    std::string EVENT_PATH = "/opt/ramdev/PVSS_projects/REMUS_TEST/data/mes/in/";
-    std::string USERFILE_PATH = "/opt/ramdev/PVSS_projects/REMUS_TEST/data/usr/in/User.dat";
+    std::string Constants::MEASUREMENT_PATH;                // Read from PVSS on driver startup from config file
+    std::string Constants::EVENT_PATH;                      // Read from PVSS on driver startup from config file
+    std::string Constants::USERFILE_PATH;                   // Read from PVSS on driver startup from config file
 
     // The map can be used to map a callback to a HwObject address
     std::map<std::string, std::function<void(const char*)>> Constants::parse_map =
@@ -41,6 +59,12 @@ namespace Common {
                 Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "setLogLvl :",std::to_string(retVal).c_str());
                 Common::Logger::setLogLvl(retVal);
             }
+        },
+        {   "_TRACEDUMP",
+            [](const char*)
+            {
+                Common::Trace::dump("request");
+            }
         }
     };
 }
@@ -53,6 +53,10 @@ namespace Common{
         static void setRemoteTsapPort(uint32_t port);
         static const uint32_t& getRemoteTsapPort();
 
+        // ISO-on-TCP port of the PLCs, 102 unless talking to a simulator
+        static void setPlcPort(uint32_t port);
+        static const uint32_t& getPlcPort();
+
         static void setPollingInterval(uint32_t pollingInterval);
         static const uint32_t& getPollingInterval();
         
@@ -65,7 +69,64 @@ namespace Common{
         static void setEventFilePath(std::string);
         static std::string& getEventFilePath();
 
+        // 0: no fsync, 1: fsync received files before publishing them, 2: also fsync their directory
+        static void setFileSyncPolicy(uint32_t policy);
+        static const uint32_t& getFileSyncPolicy();
+
+        // Size of the asynchronous logging queue in messages, 0: synchronous logging
+        static void setAsyncLogQueueSize(uint32_t size);
+        static const uint32_t& getAsyncLogQueueSize();
+
+        // Period in seconds of the per PLC statistics DPEs, 0: not published
+        static void setStatsInterval(uint32_t interval);
+        static const uint32_t& getStatsInterval();
+
+        // Spans kept per thread for the Chrome trace dumps, 0: no tracing
+        static void setTraceEvents(uint32_t events);
+        static const uint32_t& getTraceEvents();
+
+        static void setTracePath(std::string);
+        static std::string& getTracePath();
+
+        // Seconds between the keepalive reads of a passive driver, 0: no warm standby
+        static void setWarmStandby(uint32_t period);
+        static const uint32_t& getWarmStandby();
+
+        // snap7 connect (ping) and send/receive timeouts in ms, 0: snap7 defaults. Can be set per PLC IP.
+        static void setConnectTimeout(uint32_t timeout);
+        static void setIoTimeout(uint32_t timeout);
+        static void setPlcTimeouts(const std::string& ip, uint32_t connectTimeout, uint32_t ioTimeout);
+        static uint32_t getConnectTimeout(const std::string& ip);
+        static uint32_t getIoTimeout(const std::string& ip);
+
+        // Longest delay in seconds between two connection attempts to a PLC
+        static void setReconnectMax(uint32_t delay);
+        static const uint32_t& getReconnectMax();
+
+        // Folder of the last value files kept across restarts, empty: not kept
+        static void setLastValuePath(std::string);
+        static std::string& getLastValuePath();
+
+        // 1: values are stamped with the middle of their S7 request instead of the response time
+        static void setMidpointTimestamps(uint32_t midpoint);
+        static const uint32_t& getMidpointTimestamps();
+
+        // Values kept for workProc, 0: unbounded, and what happens to a value when it is full:
+        // dropOldest, keepLatest (per address) or journal (in order, to a file in journalPath)
+        static void setDeliveryQueueSize(uint32_t size);
+        static const uint32_t& getDeliveryQueueSize();
+        static void setDeliveryOverflow(std::string);
+        static std::string& getDeliveryOverflow();
+        static void setJournalPath(std::string);
+        static std::string& getJournalPath();
+
+        // Samples kept per address by a burst, at most 8191 so that the times fit in one update
+        static void setBurstSamples(uint32_t samples);
+        static const uint32_t& getBurstSamples();
+
         static const std::map<std::string,std::function<void(const char *)>>& GetParseMap();
+        // Handlers of config DPEs that need driver state (e.g. _BURST), installed by the HWService
+        static void setParseCallback(const std::string& address, std::function<void(const char *)> callback);
 
         static uint32_t getMsCopyPort();
 
@@ -75,11 +136,28 @@ namespace Common{
         static std::string MEASUREMENT_PATH;
         static std::string EVENT_PATH;
         static std::string USERFILE_PATH;
+        static std::string TRACE_PATH;
+        static std::string LAST_VALUE_PATH;
+        static std::string DELIVERY_OVERFLOW;
+        static std::string JOURNAL_PATH;
         static uint32_t DRV_NO;   // WinCC OA manager number
         static uint32_t TSAP_PORT_LOCAL;
         static uint32_t TSAP_PORT_REMOTE;
+        static uint32_t PLC_PORT;
         static uint32_t POLLING_INTERVAL;
         static uint32_t MSCOPY_PORT;
+        static uint32_t FILE_SYNC_POLICY;
+        static uint32_t ASYNC_LOG_QUEUE_SIZE;
+        static uint32_t STATS_INTERVAL;
+        static uint32_t TRACE_EVENTS;
+        static uint32_t WARM_STANDBY;
+        static uint32_t CONNECT_TIMEOUT;
+        static uint32_t IO_TIMEOUT;
+        static std::map<std::string, std::pair<uint32_t, uint32_t>> PLC_TIMEOUTS; // connect, io per PLC IP
+        static uint32_t RECONNECT_MAX;
+        static uint32_t MIDPOINT_TIMESTAMPS;
+        static uint32_t DELIVERY_QUEUE_SIZE;
+        static uint32_t BURST_SAMPLES;
 
         static std::map<std::string, std::function<void(const char *)>> parse_map;
     };
@@ -89,6 +167,11 @@ namespace Common{
         return parse_map;
     }
 
+    inline void Constants::setParseCallback(const std::string& address, std::function<void(const char *)> callback)
+    {
+        parse_map[address] = std::move(callback);
+    }
+
     inline void Constants::setDrvName(std::string dname){
         drv_name = dname;
     }
@@ -127,6 +210,15 @@ namespace Common{
         return TSAP_PORT_REMOTE;
     }
 
+    inline void Constants::setPlcPort(uint32_t port){
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting PLC_PORT=" + CharString(port));
+        PLC_PORT = port;
+    }
+
+    inline const uint32_t& Constants::getPlcPort(){
+        return PLC_PORT;
+    }
+
     inline void Constants::setPollingInterval(uint32_t pollingInterval)
     {
         Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting POLLING_INTERVAL=" + CharString(pollingInterval));
@@ -170,6 +262,175 @@ namespace Common{
         EVENT_PATH = eventFilePath;
     }
 
+    inline void Constants::setFileSyncPolicy(uint32_t policy)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting FILE_SYNC_POLICY=" + CharString(policy));
+        FILE_SYNC_POLICY = policy;
+    }
+
+    inline const uint32_t& Constants::getFileSyncPolicy()
+    {
+        return FILE_SYNC_POLICY;
+    }
+
+    inline void Constants::setAsyncLogQueueSize(uint32_t size)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting ASYNC_LOG_QUEUE_SIZE=" + CharString(size));
+        ASYNC_LOG_QUEUE_SIZE = size;
+    }
+
+    inline const uint32_t& Constants::getAsyncLogQueueSize()
+    {
+        return ASYNC_LOG_QUEUE_SIZE;
+    }
+
+    inline void Constants::setStatsInterval(uint32_t interval)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting STATS_INTERVAL=" + CharString(interval));
+        STATS_INTERVAL = interval;
+    }
+
+    inline const uint32_t& Constants::getStatsInterval()
+    {
+        return STATS_INTERVAL;
+    }
+
+    inline void Constants::setTraceEvents(uint32_t events)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting TRACE_EVENTS=" + CharString(events));
+        TRACE_EVENTS = events;
+    }
+
+    inline const uint32_t& Constants::getTraceEvents()
+    {
+        return TRACE_EVENTS;
+    }
+
+    inline void Constants::setTracePath(std::string tracePath)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting TRACE_PATH=", tracePath.c_str());
+        TRACE_PATH = tracePath;
+    }
+
+    inline std::string& Constants::getTracePath() {
+        return TRACE_PATH;
+    }
+
+    inline void Constants::setWarmStandby(uint32_t period)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting WARM_STANDBY=" + CharString(period));
+        WARM_STANDBY = period;
+    }
+
+    inline const uint32_t& Constants::getWarmStandby()
+    {
+        return WARM_STANDBY;
+    }
+
+    inline void Constants::setConnectTimeout(uint32_t timeout)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting CONNECT_TIMEOUT=" + CharString(timeout));
+        CONNECT_TIMEOUT = timeout;
+    }
+
+    inline void Constants::setIoTimeout(uint32_t timeout)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting IO_TIMEOUT=" + CharString(timeout));
+        IO_TIMEOUT = timeout;
+    }
+
+    inline void Constants::setPlcTimeouts(const std::string& ip, uint32_t connectTimeout, uint32_t ioTimeout)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,("Setting timeouts of " + ip + ": connect=" + std::to_string(connectTimeout) + " io=" + std::to_string(ioTimeout)).c_str());
+        PLC_TIMEOUTS[ip] = std::make_pair(connectTimeout, ioTimeout);
+    }
+
+    inline uint32_t Constants::getConnectTimeout(const std::string& ip)
+    {
+        const auto it = PLC_TIMEOUTS.find(ip);
+        return it != PLC_TIMEOUTS.end() ? it->second.first : CONNECT_TIMEOUT;
+    }
+
+    inline uint32_t Constants::getIoTimeout(const std::string& ip)
+    {
+        const auto it = PLC_TIMEOUTS.find(ip);
+        return it != PLC_TIMEOUTS.end() ? it->second.second : IO_TIMEOUT;
+    }
+
+    inline void Constants::setReconnectMax(uint32_t delay)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting RECONNECT_MAX=" + CharString(delay));
+        RECONNECT_MAX = delay;
+    }
+
+    inline const uint32_t& Constants::getReconnectMax()
+    {
+        return RECONNECT_MAX;
+    }
+
+    inline void Constants::setLastValuePath(std::string lastValuePath)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting LAST_VALUE_PATH=", lastValuePath.c_str());
+        LAST_VALUE_PATH = lastValuePath;
+    }
+
+    inline std::string& Constants::getLastValuePath() {
+        return LAST_VALUE_PATH;
+    }
+
+    inline void Constants::setMidpointTimestamps(uint32_t midpoint)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting MIDPOINT_TIMESTAMPS=" + CharString(midpoint));
+        MIDPOINT_TIMESTAMPS = midpoint;
+    }
+
+    inline const uint32_t& Constants::getMidpointTimestamps()
+    {
+        return MIDPOINT_TIMESTAMPS;
+    }
+
+    inline void Constants::setDeliveryQueueSize(uint32_t size)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting DELIVERY_QUEUE_SIZE=" + CharString(size));
+        DELIVERY_QUEUE_SIZE = size;
+    }
+
+    inline const uint32_t& Constants::getDeliveryQueueSize()
+    {
+        return DELIVERY_QUEUE_SIZE;
+    }
+
+    inline void Constants::setDeliveryOverflow(std::string overflow)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting DELIVERY_OVERFLOW=", overflow.c_str());
+        DELIVERY_OVERFLOW = overflow;
+    }
+
+    inline std::string& Constants::getDeliveryOverflow() {
+        return DELIVERY_OVERFLOW;
+    }
+
+    inline void Constants::setJournalPath(std::string journalPath)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting JOURNAL_PATH=", journalPath.c_str());
+        JOURNAL_PATH = journalPath;
+    }
+
+    inline std::string& Constants::getJournalPath() {
+        return JOURNAL_PATH;
+    }
+
+    inline void Constants::setBurstSamples(uint32_t samples)
+    {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"Setting BURST_SAMPLES=" + CharString(samples));
+        BURST_SAMPLES = samples;
+    }
+
+    inline const uint32_t& Constants::getBurstSamples()
+    {
+        return BURST_SAMPLES;
+    }
+
     inline uint32_t Constants::getMsCopyPort() {
         return MSCOPY_PORT;
     }
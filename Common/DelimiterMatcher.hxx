@@ -0,0 +1,89 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace Common{
+
+    /**
+     * @brief Finds a delimiter in a stream received in arbitrary chunks (Knuth-Morris-Pratt).
+     *
+     * Bytes that may still turn out to be the head of the delimiter are held back and not handed
+     * to the sink. They are always a prefix of the delimiter, so no copy of the stream is kept.
+     */
+    class DelimiterMatcher{
+        public:
+            explicit DelimiterMatcher(std::string delimiter) : _delimiter(std::move(delimiter)), _failure(_delimiter.size(), 0)
+            {
+                for(size_t i = 1, k = 0; i < _delimiter.size(); ++i) {
+                    while(k > 0 && _delimiter[i] != _delimiter[k]) {
+                        k = _failure[k - 1];
+                    }
+                    if(_delimiter[i] == _delimiter[k]) {
+                        ++k;
+                    }
+                    _failure[i] = k;
+                }
+            }
+
+            void reset() { _matched = 0; }
+
+            /**
+             * @brief Consumes a chunk of the stream
+             * @param sink : callable(const char*, size_t) receiving the content preceding the delimiter
+             * @return true when the delimiter is complete. Bytes following it in the chunk are dropped.
+             */
+            template <typename Sink>
+            bool feed(const char* data, size_t len, Sink&& sink)
+            {
+                const size_t held = _matched;
+                for(size_t i = 0; i < len; ++i) {
+                    while(_matched > 0 && data[i] != _delimiter[_matched]) {
+                        _matched = _failure[_matched - 1];
+                    }
+                    if(data[i] == _delimiter[_matched]) {
+                        ++_matched;
+                    }
+                    if(_matched == _delimiter.size()) {
+                        emit(held, data, held + i + 1 - _delimiter.size(), sink);
+                        _matched = 0;
+                        return true;
+                    }
+                }
+                emit(held, data, held + len - _matched, sink);
+                return false;
+            }
+
+        private:
+            // The first count bytes of (held delimiter prefix + data) are content
+            template <typename Sink>
+            void emit(size_t held, const char* data, size_t count, Sink& sink)
+            {
+                if(count <= held) {
+                    if(count > 0) {
+                        sink(_delimiter.data(), count);
+                    }
+                    return;
+                }
+                if(held > 0) {
+                    sink(_delimiter.data(), held);
+                }
+                sink(data, count - held);
+            }
+
+            const std::string _delimiter;
+            std::vector<size_t> _failure;
+            size_t _matched{0};
+    }; //class DelimiterMatcher
+} //namespace Common
@@ -0,0 +1,143 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace Common{
+
+    /**
+     * @brief Fixed bucket latency histogram (HDR style, log-linear), recorded lock free from any thread.
+     *
+     * Values are in microseconds. Below 8 us every value has its own bucket, above each power of two is
+     * split in 8 buckets, so a value is known within 12.5%. Values over ~30 minutes land in the last bucket.
+     * Percentiles are reported as the upper bound of their bucket: never lower than the measured latency.
+     */
+    class LatencyHistogram{
+        public:
+            static const uint32_t SUB_BUCKET_BITS = 3;
+            static const uint32_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+            static const uint32_t MAX_SHIFT = 27;
+            static const uint32_t BUCKETS = (MAX_SHIFT + 2) * SUB_BUCKETS;
+
+            class Snapshot{
+                public:
+                    Snapshot() { _counts.fill(0); }
+
+                    uint64_t count() const
+                    {
+                        uint64_t total = 0;
+                        for(auto c : _counts) {
+                            total += c;
+                        }
+                        return total;
+                    }
+
+                    /**
+                     * @brief Latency in ms under which p percent of the values are (0 if empty), p = 100 gives the max
+                     */
+                    double percentileMs(double p) const
+                    {
+                        const uint64_t total = count();
+                        if(total == 0) {
+                            return 0.0;
+                        }
+                        uint64_t rank = static_cast<uint64_t>(p / 100.0 * total + 0.5);
+                        rank = rank < 1 ? 1 : (rank > total ? total : rank);
+                        uint64_t seen = 0;
+                        for(uint32_t i = 0; i < BUCKETS; i++) {
+                            seen += _counts[i];
+                            if(seen >= rank) {
+                                return upperBoundUs(i) / 1000.0;
+                            }
+                        }
+                        return upperBoundUs(BUCKETS - 1) / 1000.0;
+                    }
+
+                    Snapshot operator-(const Snapshot& other) const
+                    {
+                        Snapshot delta;
+                        for(uint32_t i = 0; i < BUCKETS; i++) {
+                            delta._counts[i] = _counts[i] - other._counts[i];
+                        }
+                        return delta;
+                    }
+
+                private:
+                    std::array<uint64_t, BUCKETS> _counts;
+
+                friend class LatencyHistogram;
+            };
+
+            LatencyHistogram()
+            {
+                for(auto& c : _counts) {
+                    c.store(0, std::memory_order_relaxed);
+                }
+            }
+            LatencyHistogram(const LatencyHistogram&) = delete;
+            LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+            void record(std::chrono::steady_clock::duration latency)
+            {
+                const auto us = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+                _counts[bucketOf(us > 0 ? static_cast<uint64_t>(us) : 0)].fetch_add(1, std::memory_order_relaxed);
+            }
+
+            // Everything recorded since the start of the driver
+            Snapshot snapshot() const
+            {
+                Snapshot s;
+                for(uint32_t i = 0; i < BUCKETS; i++) {
+                    s._counts[i] = _counts[i].load(std::memory_order_relaxed);
+                }
+                return s;
+            }
+
+            // What was recorded since the previous call. Not thread safe: one caller (the publisher)
+            Snapshot interval()
+            {
+                Snapshot current = snapshot();
+                Snapshot delta = current - _published;
+                _published = current;
+                return delta;
+            }
+
+            static uint32_t bucketOf(uint64_t us)
+            {
+                if(us < SUB_BUCKETS) {
+                    return static_cast<uint32_t>(us);
+                }
+                const uint32_t shift = 63 - __builtin_clzll(us) - SUB_BUCKET_BITS;
+                if(shift > MAX_SHIFT) {
+                    return BUCKETS - 1;
+                }
+                return (shift + 1) * SUB_BUCKETS + static_cast<uint32_t>((us >> shift) & (SUB_BUCKETS - 1));
+            }
+
+            static uint64_t upperBoundUs(uint32_t bucket)
+            {
+                if(bucket < SUB_BUCKETS) {
+                    return bucket + 1;
+                }
+                const uint32_t shift = bucket / SUB_BUCKETS - 1;
+                return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS + 1) << shift;
+            }
+
+        private:
+            std::array<std::atomic<uint64_t>, BUCKETS> _counts;
+            Snapshot _published;
+    };
+}
@@ -14,15 +14,256 @@
 
 #include "Logger.hxx"
 #include "Common/Constants.hxx"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <ctime>
 #include <mutex>
+#include <thread>
+#include <sys/time.h>
 
 namespace Common {
 
 int16_t Logger::loggingLevel = 1;
 const char * Logger::timestrformat = "%a, %d.%m.%Y %H:%M:%S";
 
+namespace {
+
+/*!
+ * Fixed-size log message, notes are truncated to fit
+ */
+struct LogRecord {
+	static const size_t TEXT_SIZE = 1000;
+
+	ErrClass::ErrPrio prio;
+	struct timeval time;
+	uint16_t length[3];
+	bool present[3];
+	char text[TEXT_SIZE];
+};
+
+/*!
+ * Bounded multi-producer / single-consumer ring. Producers claim a slot with one CAS on the tail,
+ * every slot carries a sequence number telling whether it is free, being written, or readable.
+ */
+class LogRing {
+public:
+	explicit LogRing(size_t capacity) : _mask(capacity - 1), _slots(new Slot[capacity]) {
+		for(size_t i = 0; i < capacity; i++) {
+			_slots[i].seq.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	bool push(ErrClass::ErrPrio prio, const char *note1, const char* note2, const char* note3) {
+		size_t pos = _tail.load(std::memory_order_relaxed);
+		Slot* slot;
+		for(;;) {
+			slot = &_slots[pos & _mask];
+			const size_t seq = slot->seq.load(std::memory_order_acquire);
+			const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+			if(diff == 0) {
+				if(_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if(diff < 0) {
+				return false; // full
+			} else {
+				pos = _tail.load(std::memory_order_relaxed);
+			}
+		}
+
+		LogRecord& rec = slot->rec;
+		rec.prio = prio;
+		gettimeofday(&rec.time, nullptr);
+		// Notes are stored back to back, each followed by its terminating null
+		const char* notes[3] = {note1, note2, note3};
+		size_t offset = 0;
+		size_t budget = LogRecord::TEXT_SIZE - 3;
+		for(int i = 0; i < 3; i++) {
+			rec.present[i] = notes[i] != nullptr;
+			const size_t len = notes[i] ? strnlen(notes[i], budget) : 0;
+			if(len > 0) {
+				memcpy(rec.text + offset, notes[i], len);
+			}
+			rec.text[offset + len] = '\0';
+			rec.length[i] = static_cast<uint16_t>(len);
+			offset += len + 1;
+			budget -= len;
+		}
+
+		slot->seq.store(pos + 1, std::memory_order_release);
+		return true;
+	}
+
+	// Single consumer
+	bool pop(LogRecord& rec) {
+		Slot& slot = _slots[_head & _mask];
+		if(slot.seq.load(std::memory_order_acquire) != _head + 1) {
+			return false;
+		}
+		rec = slot.rec;
+		slot.seq.store(_head + _mask + 1, std::memory_order_release);
+		++_head;
+		return true;
+	}
+
+private:
+	struct Slot {
+		std::atomic<size_t> seq;
+		LogRecord rec;
+	};
+
+	const size_t _mask;
+	std::unique_ptr<Slot[]> _slots;
+	// Producers and consumer indices on separate cache lines
+	char _pad0[64];
+	std::atomic<size_t> _tail{0};
+	char _pad1[64];
+	size_t _head{0};
+};
+
+struct AsyncLog {
+	std::atomic<bool> enabled{false};
+	std::atomic<int> producers{0};
+	std::atomic<uint64_t> dropped{0};
+	std::atomic<bool> sleeping{false};
+	std::unique_ptr<LogRing> ring;
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool run{false};
+};
+
+AsyncLog& asyncLog() {
+	static AsyncLog instance;
+	return instance;
+}
+
+void forward(const LogRecord& rec) {
+	// The time of the call is kept: ErrHdl only sees the time the record is forwarded
+	char stamp[32];
+	struct tm tmTime;
+	localtime_r(&rec.time.tv_sec, &tmTime);
+	const size_t len = strftime(stamp, sizeof(stamp), "[%H:%M:%S", &tmTime);
+	snprintf(stamp + len, sizeof(stamp) - len, ".%06ld] ", static_cast<long>(rec.time.tv_usec));
+
+	const char* notes[3];
+	size_t offset = 0;
+	for(int i = 0; i < 3; i++) {
+		notes[i] = rec.present[i] ? rec.text + offset : nullptr;
+		offset += rec.length[i] + 1;
+	}
+	const CharString first = CharString(stamp) + (notes[0] ? notes[0] : "");
+	ErrHdl::error(rec.prio, ErrClass::ERR_CONTROL, ErrClass::NOERR, first, notes[1], notes[2]);
+}
+
+size_t drain(LogRing& ring) {
+	LogRecord rec;
+	size_t count = 0;
+	while(ring.pop(rec)) {
+		forward(rec);
+		++count;
+	}
+	return count;
+}
+
+void reportDropped(uint64_t& reported) {
+	const uint64_t dropped = asyncLog().dropped.load(std::memory_order_relaxed);
+	if(dropped != reported) {
+		ErrHdl::error(ErrClass::PRIO_WARNING, ErrClass::ERR_CONTROL, ErrClass::NOERR,
+			"Logger: asynchronous log queue full,", CharString(static_cast<int>(dropped - reported)), "messages dropped");
+		reported = dropped;
+	}
+}
+
+void consume() {
+	AsyncLog& log = asyncLog();
+	uint64_t reported = 0;
+	for(;;) {
+		{
+			std::unique_lock<std::mutex> lock(log.mutex);
+			if(!log.run) {
+				break;
+			}
+		}
+		if(drain(*log.ring) == 0) {
+			reportDropped(reported);
+			std::unique_lock<std::mutex> lock(log.mutex);
+			log.sleeping.store(true);
+			// Producers only notify a sleeping consumer, the timeout covers a missed notification
+			log.cv.wait_for(lock, std::chrono::milliseconds(100), [&log]{ return !log.run; });
+			log.sleeping.store(false);
+		}
+	}
+	drain(*log.ring);
+	reportDropped(reported);
+}
+
+// true if the message was taken by the asynchronous logger
+bool enqueue(ErrClass::ErrPrio prio, const char *note1, const char* note2, const char* note3) {
+	AsyncLog& log = asyncLog();
+	if(!log.enabled.load(std::memory_order_acquire)) {
+		return false;
+	}
+	log.producers.fetch_add(1, std::memory_order_acq_rel);
+	if(!log.enabled.load(std::memory_order_acquire)) {
+		log.producers.fetch_sub(1, std::memory_order_release);
+		return false;
+	}
+	if(!log.ring->push(prio, note1, note2, note3)) {
+		log.dropped.fetch_add(1, std::memory_order_relaxed);
+	} else if(log.sleeping.load(std::memory_order_relaxed)) {
+		log.cv.notify_one();
+	}
+	log.producers.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+} // namespace
+
+void Logger::startAsync(uint32_t capacity){
+	AsyncLog& log = asyncLog();
+	if(capacity == 0 || log.enabled.load()) {
+		return;
+	}
+	size_t size = 1;
+	while(size < capacity) {
+		size <<= 1;
+	}
+	log.ring.reset(new LogRing(size));
+	{
+		std::lock_guard<std::mutex> lock(log.mutex);
+		log.run = true;
+	}
+	log.thread = std::thread(consume);
+	log.enabled.store(true, std::memory_order_release);
+	globalInfo(L1, __PRETTY_FUNCTION__, "Asynchronous logging enabled, queue size:", CharString(static_cast<int>(size)));
+}
+
+void Logger::stopAsync(){
+	AsyncLog& log = asyncLog();
+	if(!log.enabled.exchange(false)) {
+		return;
+	}
+	// Producers that saw the flag set finish their push before the final drain
+	while(log.producers.load(std::memory_order_acquire) != 0) {
+		std::this_thread::yield();
+	}
+	{
+		std::lock_guard<std::mutex> lock(log.mutex);
+		log.run = false;
+	}
+	log.cv.notify_one();
+	log.thread.join();
+}
+
+uint64_t Logger::getDroppedCount(){
+	return asyncLog().dropped.load(std::memory_order_relaxed);
+}
+
 void Logger::globalInfo(int lvl, const char *note1, const char* note2, const char* note3){
-	if(loggingLevel > 0 && loggingLevel >= lvl){
+	if(isEnabled(lvl) && !enqueue(ErrClass::PRIO_INFO, note1, note2, note3)){
 		ErrHdl::error(
 				ErrClass::PRIO_INFO,
 				ErrClass::ERR_CONTROL,
@@ -34,7 +275,7 @@ void Logger::globalInfo(int lvl, const char *note1, const char* note2, const cha
 }
 
 void Logger::globalWarning(const char *note1, const char* note2, const char* note3){
-	if(loggingLevel > L0){
+	if(loggingLevel > L0 && !enqueue(ErrClass::PRIO_WARNING, note1, note2, note3)){
 		ErrHdl::error(
 				ErrClass::PRIO_WARNING,
 				ErrClass::ERR_CONTROL,
@@ -45,6 +286,7 @@ void Logger::globalWarning(const char *note1, const char* note2, const char* not
 	}
 }
 
+// Errors are always written synchronously
 void Logger::globalError(const char *note1, const char* note2, const char* note3){
 	if(loggingLevel > L0){
 		ErrHdl::error(
@@ -15,6 +15,7 @@
 #ifndef DEBUGMETHODS_HXX
 #define DEBUGMETHODS_HXX
 
+#include <fstream>
 #include <iostream>
 #include <Resources.hxx>
 
@@ -60,6 +61,30 @@ public:
 
 	static void globalInfo(int lvl, const char *note1 = NULL, const char* note2 = NULL, const char* note3 = NULL);
 
+	/*!
+	 * True if globalInfo messages of the given level are currently written.
+	 * Guard message construction with it (or use LOGGER_INFO) on hot paths.
+	 */
+	static bool isEnabled(int lvl);
+
+	/*!
+	 * Asynchronous mode: globalInfo/globalWarning copy the message into a bounded lock-free queue
+	 * and a background thread forwards it to ErrHdl, prefixed with the time of the call.
+	 * Messages are dropped and counted when the queue is full. globalError stays synchronous.
+	 * \param capacity queue size in messages, rounded up to a power of two (0: stay synchronous)
+	 */
+	static void startAsync(uint32_t capacity);
+
+	/*!
+	 * Forwards the messages still queued, stops the background thread and returns to synchronous logging
+	 */
+	static void stopAsync();
+
+	/*!
+	 * Number of messages dropped because the asynchronous queue was full
+	 */
+	static uint64_t getDroppedCount();
+
 	static void globalWarning(const char *note1 = NULL, const char* note2 = NULL, const char* note3 = NULL);
 
 	static void globalError(const char *note1 = NULL, const char* note2 = NULL, const char* note3 = NULL);
@@ -104,6 +129,10 @@ inline const int Logger::getLogLevel(){
     return loggingLevel;
 }
 
+inline bool Logger::isEnabled(int lvl){
+    return loggingLevel > 0 && loggingLevel >= lvl;
+}
+
 inline void Logger::setDevNum(int num){
     lock_guard<mutex> raiiLock(localVariableDataAccess);
 	devNum = num;
@@ -115,4 +144,14 @@ inline void Logger::updatePrefix(){
 }
 
 }//namespace
+
+/*!
+ * Level checked Logger::globalInfo: the message arguments (string concatenations, std::to_string,
+ * dumps...) are not evaluated at all when the level is filtered out.
+ *
+ * LOGGER_INFO(Common::Logger::L3, __PRETTY_FUNCTION__, "Value: ", std::to_string(value).c_str());
+ */
+#define LOGGER_INFO(lvl, ...) \
+	do { if(Common::Logger::isEnabled(lvl)) { Common::Logger::globalInfo(lvl, __VA_ARGS__); } } while(0)
+
 #endif /* DEBUGMETHODS_HXX_ */
@@ -145,6 +145,26 @@ namespace Common{
                 }
             }
 
+            /**
+             * @brief Number of items, from the first one, that fit together in one ReadMultiVars/WriteMultiVars
+             * request of at most maxItems items. 0 when the first item alone does not fit in the PDU.
+             * @param requestSize : size of the items and their overhead, without the message overhead
+             */
+            static unsigned int ItemsInRequest(const TS7DataItem* items, size_t count, unsigned int maxItems, int pduSize, int varOverhead, int msgOverhead, int& requestSize)
+            {
+                unsigned int toSend = 0;
+                requestSize = 0;
+                for(size_t i = 0; i < count && toSend < maxItems; i++) {
+                    const int itemSize = DataSizeByte(items[i].WordLen) * items[i].Amount + varOverhead;
+                    if(requestSize + itemSize >= pduSize - msgOverhead) {
+                        break;
+                    }
+                    requestSize += itemSize;
+                    ++toSend;
+                }
+                return toSend;
+            }
+
             static bool AddressIsValid(const std::string& Address){
                 return AddressGetArea(Address)!=-1 && 
                 AddressGetWordLen(Address)!=-1 &&
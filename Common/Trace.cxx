@@ -0,0 +1,195 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "Trace.hxx"
+#include "Common/Constants.hxx"
+#include "Common/Logger.hxx"
+#include <cstdio>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Common {
+
+std::atomic<bool> Trace::enabled{false};
+
+namespace {
+
+struct TraceEvent {
+	const char* name;
+	Trace::clock::time_point start;
+	Trace::clock::duration duration;
+	int64_t arg;
+};
+
+/*!
+ * Last spans of one thread. The mutex is only contended while a dump copies the ring.
+ */
+struct ThreadBuffer {
+	ThreadBuffer(uint32_t id, size_t capacity) : id(id), events(capacity) {}
+
+	const uint32_t id;
+	std::mutex mutex;
+	std::string name;
+	std::vector<TraceEvent> events;
+	size_t next{0};
+	bool wrapped{false};
+};
+
+struct Tracer {
+	std::mutex mutex;    // buffers list, dumps
+	std::vector<std::unique_ptr<ThreadBuffer>> buffers; // kept when threads exit, their spans are still of interest
+	size_t capacity{0};
+	Trace::clock::time_point epoch{Trace::clock::now()};
+	Trace::clock::time_point lastDump;
+	bool dumped{false};
+
+	static Tracer& get() {
+		static Tracer tracer;
+		return tracer;
+	}
+
+	ThreadBuffer* registerThread() {
+		std::lock_guard<std::mutex> lock{mutex};
+		buffers.emplace_back(new ThreadBuffer(buffers.size() + 1, capacity));
+		return buffers.back().get();
+	}
+};
+
+thread_local ThreadBuffer* threadBuffer = nullptr;
+
+ThreadBuffer* currentBuffer() {
+	if(!threadBuffer) {
+		threadBuffer = Tracer::get().registerThread();
+	}
+	return threadBuffer;
+}
+
+// Names are literals from the driver, but thread names hold IPs: keep the JSON valid anyway
+void writeJsonString(FILE* f, const char* s) {
+	fputc('"', f);
+	for(; *s; s++) {
+		if(*s == '"' || *s == '\\') {
+			fputc('\\', f);
+		}
+		fputc(static_cast<unsigned char>(*s) < 0x20 ? ' ' : *s, f);
+	}
+	fputc('"', f);
+}
+
+} // namespace
+
+void Trace::enable(uint32_t eventsPerThread)
+{
+	if(eventsPerThread == 0) {
+		return;
+	}
+	Tracer::get().capacity = eventsPerThread;
+	enabled.store(true);
+	Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, ("Tracing enabled, spans kept per thread: " + std::to_string(eventsPerThread)).c_str());
+}
+
+void Trace::setThreadName(const std::string& name)
+{
+	if(!isEnabled()) {
+		return;
+	}
+	auto buffer = currentBuffer();
+	std::lock_guard<std::mutex> lock{buffer->mutex};
+	buffer->name = name;
+}
+
+void Trace::record(const char* name, clock::time_point start, clock::time_point end, int64_t arg)
+{
+	if(!isEnabled()) {
+		return;
+	}
+	auto buffer = currentBuffer();
+	std::lock_guard<std::mutex> lock{buffer->mutex};
+	buffer->events[buffer->next] = TraceEvent{name, start, end - start, arg};
+	if(++buffer->next == buffer->events.size()) {
+		buffer->next = 0;
+		buffer->wrapped = true;
+	}
+}
+
+bool Trace::dump(const char* reason, std::chrono::seconds minPeriod)
+{
+	if(!isEnabled()) {
+		Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Tracing is not enabled (traceEvents)");
+		return false;
+	}
+	auto& tracer = Tracer::get();
+	std::lock_guard<std::mutex> lock{tracer.mutex};
+	const auto now = clock::now();
+	if(tracer.dumped && now - tracer.lastDump < minPeriod) {
+		return false;
+	}
+	tracer.dumped = true;
+	tracer.lastDump = now;
+
+	char timestamp[32];
+	const time_t t = time(nullptr);
+	struct tm tm;
+	strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", localtime_r(&t, &tm));
+	const std::string fileName = Common::Constants::getTracePath() + "RAMS7200_" + timestamp + "_" + reason + ".json";
+	const std::string tmpFileName = fileName + ".part";
+
+	FILE* f = fopen(tmpFileName.c_str(), "w");
+	if(!f) {
+		Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Cannot create trace file:", tmpFileName.c_str());
+		return false;
+	}
+
+	size_t count = 0;
+	fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", f);
+	std::vector<TraceEvent> events;
+	for(auto& buffer : tracer.buffers) {
+		std::string name;
+		{
+			// Copy, so that the thread is not held while writing the file
+			std::lock_guard<std::mutex> bufferLock{buffer->mutex};
+			name = buffer->name;
+			events.assign(buffer->events.begin() + (buffer->wrapped ? buffer->next : 0), buffer->events.begin() + (buffer->wrapped ? buffer->events.size() : buffer->next));
+			events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + (buffer->wrapped ? buffer->next : 0));
+		}
+		fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", buffer->id);
+		writeJsonString(f, name.empty() ? ("thread " + std::to_string(buffer->id)).c_str() : name.c_str());
+		fputs("}}", f);
+		for(const auto& e : events) {
+			fputs(",\n{\"name\":", f);
+			writeJsonString(f, e.name);
+			fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", buffer->id,
+				std::chrono::duration<double, std::micro>(e.start - tracer.epoch).count(),
+				std::chrono::duration<double, std::micro>(e.duration).count());
+			if(e.arg >= 0) {
+				fprintf(f, ",\"args\":{\"n\":%lld}", static_cast<long long>(e.arg));
+			}
+			fputc('}', f);
+		}
+		fputs(buffer == tracer.buffers.back() ? "\n" : ",\n", f);
+		count += events.size();
+	}
+	fputs("]}\n", f);
+
+	const bool ok = fclose(f) == 0 && rename(tmpFileName.c_str(), fileName.c_str()) == 0;
+	if(!ok) {
+		Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Cannot write trace file:", fileName.c_str());
+		remove(tmpFileName.c_str());
+		return false;
+	}
+	Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, ("Trace of " + std::to_string(count) + " spans written to").c_str(), fileName.c_str());
+	return true;
+}
+
+}
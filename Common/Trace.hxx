@@ -0,0 +1,74 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Common{
+
+    /**
+     * @brief Opt-in span tracing, dumped in the Chrome trace event format (chrome://tracing, Perfetto).
+     *
+     * Every thread records its last spans in its own ring buffer, so tracing threads do not contend
+     * with each other. Span names must be string literals: only the pointer is kept.
+     */
+    class Trace{
+        public:
+            using clock = std::chrono::steady_clock;
+
+            // Keep the last eventsPerThread spans of every thread, 0: disabled
+            static void enable(uint32_t eventsPerThread);
+            static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+            // Name of the calling thread in the dumps
+            static void setThreadName(const std::string& name);
+
+            static void record(const char* name, clock::time_point start, clock::time_point end, int64_t arg = -1);
+
+            /**
+             * @brief Writes the buffered spans of all threads to <tracePath>RAMS7200_<time>_<reason>.json
+             * @param minPeriod : do nothing if the previous dump is more recent (overrun dumps)
+             * @return false if nothing was written
+             */
+            static bool dump(const char* reason, std::chrono::seconds minPeriod = std::chrono::seconds(0));
+
+            // Records a span from construction to destruction
+            class Span{
+                public:
+                    explicit Span(const char* name) : _name(isEnabled() ? name : nullptr) {
+                        if(_name) {
+                            _start = clock::now();
+                        }
+                    }
+                    ~Span() {
+                        if(_name) {
+                            record(_name, _start, clock::now(), _arg);
+                        }
+                    }
+                    Span(const Span&) = delete;
+                    Span& operator=(const Span&) = delete;
+
+                    void setArg(int64_t arg) { _arg = arg; }
+
+                private:
+                    const char* _name;
+                    clock::time_point _start;
+                    int64_t _arg{-1};
+            };
+
+        private:
+            static std::atomic<bool> enabled;
+    };
+}
@@ -0,0 +1,46 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Stand-in for the WinCC OA CharString, used by headless builds (no API_ROOT). Only what the
+// driver core needs: construction from C strings and numbers, concatenation, conversion to const char*.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class CharString
+{
+public:
+    CharString() = default;
+    CharString(const char* text) : _text(text ? text : "") {}
+    CharString(const char* text, size_t length) : _text(text, length) {}
+    CharString(char c) : _text(1, c) {}
+    CharString(int value) : _text(std::to_string(value)) {}
+    CharString(unsigned int value) : _text(std::to_string(value)) {}
+    CharString(long value) : _text(std::to_string(value)) {}
+    CharString(unsigned long value) : _text(std::to_string(value)) {}
+    CharString(long long value) : _text(std::to_string(value)) {}
+    CharString(unsigned long long value) : _text(std::to_string(value)) {}
+    CharString(double value) : _text(std::to_string(value)) {}
+
+    operator const char*() const {return _text.c_str();}
+    operator char*() {return &_text[0];}
+    const char* c_str() const {return _text.c_str();}
+    size_t len() const {return _text.size();}
+
+    CharString& operator+=(const CharString& other) {_text += other._text; return *this;}
+    friend CharString operator+(const CharString& a, const CharString& b) {CharString result(a); return result += b;}
+
+private:
+    std::string _text;
+};
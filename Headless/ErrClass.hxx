@@ -0,0 +1,23 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Stand-in for the WinCC OA ErrClass, used by headless builds (no API_ROOT)
+
+#pragma once
+
+class ErrClass
+{
+public:
+    enum ErrPrio {PRIO_FATAL, PRIO_SEVERE, PRIO_WARNING, PRIO_INFO};
+    enum ErrType {ERR_IMPL, ERR_PARAM, ERR_SYSTEM, ERR_CONTROL, ERR_REDUNDANCY};
+    enum ErrCode {NOERR, UNEXPECTEDSTATE};
+};
@@ -0,0 +1,38 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Stand-in for the WinCC OA ErrHdl, used by headless builds (no API_ROOT): messages go to stderr
+// in the layout of the WinCC OA log.
+
+#pragma once
+
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include "ErrClass.hxx"
+
+class ErrHdl
+{
+public:
+    static void error(ErrClass::ErrPrio prio, ErrClass::ErrType, ErrClass::ErrCode,
+                      const char* note1 = nullptr, const char* note2 = nullptr, const char* note3 = nullptr)
+    {
+        static const char* const prios[] = {"FATAL", "SEVERE", "WARNING", "INFO"};
+        static std::mutex mutex;
+        char stamp[32];
+        const time_t t = time(nullptr);
+        struct tm tm;
+        strftime(stamp, sizeof(stamp), "%Y.%m.%d %H:%M:%S", localtime_r(&t, &tm));
+        std::lock_guard<std::mutex> lock{mutex};
+        fprintf(stderr, "WCCOArams7200 %s, %s, %s %s %s\n", stamp, prios[prio], note1 ? note1 : "", note2 ? note2 : "", note3 ? note3 : "");
+    }
+};
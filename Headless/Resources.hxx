@@ -0,0 +1,18 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Stand-in for the WinCC OA Resources, used by headless builds (no API_ROOT). The driver core
+// only needs the types it brings along.
+
+#pragma once
+
+#include "CharString.hxx"
@@ -0,0 +1,34 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+/**
+ * @brief What the driver core (MS, LibFacade, Panel, delivery queue) needs from the WinCC OA
+ * manager around it. RAMS7200HWService installs the DrvRsrce state at initialization; without it
+ * (headless builds, load tests) the core runs as the active side of a non redundant system.
+ */
+class RAMS7200Adapter
+{
+public:
+    using DisableCommandsFn = bool (*)();
+
+    static void setDisableCommands(DisableCommandsFn fn) {disableCommands = fn;}
+
+    /**
+     * @return true on the passive side of a redundant system: no commands to the PLCs, no connection state sent
+     */
+    static bool getDisableCommands() {return disableCommands && disableCommands();}
+
+private:
+    static DisableCommandsFn disableCommands;
+};
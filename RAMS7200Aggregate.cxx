@@ -0,0 +1,109 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200Aggregate.hxx"
+#include "Common/S7Utils.hxx"
+#include "Common/Utils.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+bool RAMS7200Aggregation::parse(const std::string& field, RAMS7200Aggregation& aggregation)
+{
+    size_t digits;
+    if(field.compare(0, 3, "min") == 0) {
+        aggregation.function = Function::MIN;
+        digits = 3;
+    } else if(field.compare(0, 3, "max") == 0) {
+        aggregation.function = Function::MAX;
+        digits = 3;
+    } else if(field.compare(0, 4, "mean") == 0) {
+        aggregation.function = Function::MEAN;
+        digits = 4;
+    } else {
+        return false;
+    }
+    if(digits == field.size() || field.find_first_not_of("0123456789", digits) != std::string::npos) {
+        return false;
+    }
+    aggregation.period = static_cast<uint32_t>(strtoul(field.c_str() + digits, nullptr, 10));
+    aggregation.field = field;
+    return aggregation.period > 0;
+}
+
+bool RAMS7200Aggregation::supports(int wordLen) const
+{
+    return function != Function::MEAN || wordLen == S7WLReal;
+}
+
+bool RAMS7200Aggregator::add(const RAMS7200Aggregation& aggregation, const char* raw, std::chrono::system_clock::time_point acquired,
+    char* result, std::chrono::system_clock::time_point& windowStart)
+{
+    const auto period = std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::seconds(aggregation.period));
+    const auto start = acquired - (acquired.time_since_epoch() % period);
+
+    bool closed = false;
+    if(start != _windowStart) {
+        if(_count > 0) {
+            switch(aggregation.function) {
+                case RAMS7200Aggregation::Function::MIN: encode(aggregation.wordLen, _min, result); break;
+                case RAMS7200Aggregation::Function::MAX: encode(aggregation.wordLen, _max, result); break;
+                case RAMS7200Aggregation::Function::MEAN: encode(aggregation.wordLen, _sum / _count, result); break;
+            }
+            windowStart = _windowStart;
+            closed = true;
+        }
+        _windowStart = start;
+        _count = 0;
+        _sum = 0;
+    }
+
+    const double value = decode(aggregation.wordLen, raw);
+    _min = _count ? std::min(_min, value) : value;
+    _max = _count ? std::max(_max, value) : value;
+    _sum += value;
+    ++_count;
+    return closed;
+}
+
+double RAMS7200Aggregator::decode(int wordLen, const char* raw)
+{
+    switch(wordLen) {
+        case S7WLBit: return *raw ? 1 : 0;
+        case S7WLByte: return *reinterpret_cast<const uint8_t*>(raw);
+        case S7WLWord: return Common::Utils::CopyNSwapBytes<int16_t>(raw);
+        default: return Common::Utils::CopyNSwapBytes<float>(raw);
+    }
+}
+
+void RAMS7200Aggregator::encode(int wordLen, double value, char* raw)
+{
+    switch(wordLen) {
+        case S7WLBit:
+            *raw = value >= 0.5 ? 1 : 0;
+            break;
+        case S7WLByte:
+            *reinterpret_cast<uint8_t*>(raw) = static_cast<uint8_t>(std::lround(value));
+            break;
+        case S7WLWord: {
+            const int16_t word = Common::Utils::CopyNSwapBytes(static_cast<int16_t>(std::lround(value)));
+            memcpy(raw, &word, sizeof(word));
+            break;
+        }
+        default: {
+            const float real = Common::Utils::CopyNSwapBytes(static_cast<float>(value));
+            memcpy(raw, &real, sizeof(real));
+            break;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Aggregation of an address, from the last field of `<IP_COMBO>$<var>$<poll>$<function><seconds>`,
+ * e.g. mean60: the mean of the polled values over every minute
+ */
+struct RAMS7200Aggregation
+{
+    enum class Function {MIN, MAX, MEAN};
+
+    Function function;
+    uint32_t period;    // seconds
+    int wordLen;        // S7 word length of the address, to decode its values
+    std::string field;  // as in the address
+
+    /**
+     * @return false if the field is not min<seconds>, max<seconds> or mean<seconds>
+     */
+    static bool parse(const std::string& field, RAMS7200Aggregation& aggregation);
+
+    /**
+     * @return false for the mean of a bit or an integer address, which would be rounded to the type
+     * of the address: only the mean of a REAL is delivered
+     */
+    bool supports(int wordLen) const;
+};
+
+/**
+ * @brief Window of an aggregation. Windows are aligned on the epoch, so that 60 s windows are
+ * calendar minutes. Used by the PLC thread only.
+ */
+class RAMS7200Aggregator
+{
+public:
+    /**
+     * @brief Adds a raw S7 value read at the given time. When it is the first value of a new window,
+     * the previous window, if it had values, is closed first.
+     * @param result : raw S7 value of the closed window, of the size of the address
+     * @param windowStart : start of the closed window
+     * @return true if a window was closed
+     */
+    bool add(const RAMS7200Aggregation& aggregation, const char* raw, std::chrono::system_clock::time_point acquired,
+        char* result, std::chrono::system_clock::time_point& windowStart);
+
+    static double decode(int wordLen, const char* raw);
+    // Rounded for the integer and bit addresses, exact for their min and max
+    static void encode(int wordLen, double value, char* raw);
+
+private:
+    double _min{0};
+    double _max{0};
+    double _sum{0};
+    uint64_t _count{0};
+    std::chrono::system_clock::time_point _windowStart;
+};
@@ -0,0 +1,231 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200Burst.hxx"
+#include "RAMS7200Adapter.hxx"
+#include "Common/Constants.hxx"
+#include "Common/Logger.hxx"
+#include "Common/S7Utils.hxx"
+#include "Common/Trace.hxx"
+
+#include <algorithm>
+#include <cstring>
+
+// The times of the samples are one update of at most 65535 bytes: a kind byte and 8 bytes per sample
+static const uint32_t MAX_SAMPLES = (UINT16_MAX - 1) / sizeof(int64_t);
+// Failed requests in a row before a burst is given up, and the pause after each
+static const int MAX_FAILED_IN_ROW = 10;
+static const std::chrono::milliseconds FAILED_PAUSE{10};
+
+static char SampleKind(int wordLen)
+{
+    switch(wordLen) {
+        case S7WLBit: return 'X';
+        case S7WLByte: return 'B';
+        case S7WLWord: return 'W';
+        default: return 'D';
+    }
+}
+
+RAMS7200Burst::RAMS7200Burst(const std::string& ip, const std::string& ipCombo, queueBatchToDPCallback cb)
+    : _ip(ip), _ipCombo(ipCombo), _queueBatchToDPCB(cb)
+{
+}
+
+RAMS7200Burst::~RAMS7200Burst()
+{
+    stop();
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+bool RAMS7200Burst::start(const std::vector<std::string>& vars, std::chrono::milliseconds duration)
+{
+    if(_running) {
+        return false;
+    }
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+    _running = true;
+    _thread = std::thread(&RAMS7200Burst::Run, this, vars, duration);
+    return true;
+}
+
+void RAMS7200Burst::Run(std::vector<std::string> vars, std::chrono::milliseconds duration)
+{
+    Common::Trace::setThreadName("burst " + _ipCombo);
+
+    // One request per sample: the addresses that do not fit in it are left out
+    std::vector<TS7DataItem> items;
+    for(auto it = vars.begin(); it != vars.end(); ) {
+        if(Common::S7Utils::AddressGetAmount(*it) != 1) {
+            Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Burst sampling of byte arrays is not supported, skipping:", it->c_str());
+            it = vars.erase(it);
+        } else {
+            items.push_back(Common::S7Utils::TS7DataItemFromAddress(*it));
+            items.back().pdata = new char[Common::S7Utils::DataSizeByte(items.back().WordLen)];
+            ++it;
+        }
+    }
+    int requestSize = 0;
+    const size_t sampled = Common::S7Utils::ItemsInRequest(items.data(), items.size(), 19, PDU_SIZE, OVERHEAD_READ_VARIABLE, OVERHEAD_READ_MESSAGE, requestSize);
+    for(size_t i = sampled; i < items.size(); i++) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Burst request full, skipping:", vars[i].c_str());
+        delete[] static_cast<char*>(items[i].pdata);
+    }
+    items.resize(sampled);
+    vars.resize(sampled);
+
+    TS7Client client;
+    client.SetConnectionParams(_ip.c_str(), Common::Constants::getLocalTsapPort(), Common::Constants::getRemoteTsapPort());
+    uint16_t port = Common::Constants::getPlcPort();
+    client.SetParam(p_u16_RemotePort, &port);
+    int32_t connectTimeout = Common::Constants::getConnectTimeout(_ip);
+    if(connectTimeout > 0) {
+        client.SetParam(p_i32_PingTimeout, &connectTimeout);
+    }
+    int32_t ioTimeout = Common::Constants::getIoTimeout(_ip);
+    if(ioTimeout > 0) {
+        client.SetParam(p_i32_SendTimeout, &ioTimeout);
+        client.SetParam(p_i32_RecvTimeout, &ioTimeout);
+    }
+
+    if(items.empty()) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "No address to sample for PLC:", _ip.c_str());
+    } else if(client.Connect() != 0) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Burst connection failed for PLC:", _ip.c_str());
+    } else if(!Probe(client, vars, items)) {
+        client.Disconnect();
+    } else {
+        // Ring buffer: sample n of every item at n % capacity
+        std::vector<size_t> offsets;
+        size_t sampleSize = 0;
+        for(const auto& item : items) {
+            offsets.push_back(sampleSize);
+            sampleSize += Common::S7Utils::DataSizeByte(item.WordLen);
+        }
+        const uint32_t capacity = std::max<uint32_t>(1, std::min(Common::Constants::getBurstSamples(), MAX_SAMPLES));
+        std::vector<char> samples(capacity * sampleSize);
+        std::vector<std::chrono::system_clock::time_point> times(capacity);
+
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, ("Burst started for PLC " + _ip + ", addresses: " + std::to_string(items.size())).c_str(),
+            ("ms: " + std::to_string(duration.count())).c_str());
+        uint64_t taken = 0, failed = 0;
+        int failedInRow = 0;
+        const auto start = std::chrono::steady_clock::now();
+        const auto end = start + duration;
+        while(!_stop && std::chrono::steady_clock::now() < end && !RAMS7200Adapter::getDisableCommands()) {
+            const auto requestStart = std::chrono::steady_clock::now();
+            const int result = client.ReadMultiVars(items.data(), items.size());
+            const auto requestEnd = std::chrono::steady_clock::now();
+            if(result != 0 || std::any_of(items.begin(), items.end(), [](const TS7DataItem& item) { return item.Result != 0; })) {
+                // A sample has every address or none
+                ++failed;
+                if(!client.Connected()) {
+                    Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Burst connection lost for PLC:", _ip.c_str());
+                    break;
+                }
+                if(++failedInRow == MAX_FAILED_IN_ROW) {
+                    Common::Logger::globalWarning(__PRETTY_FUNCTION__, ("Burst given up after failed requests in a row: " + std::to_string(failedInRow)).c_str(), _ip.c_str());
+                    break;
+                }
+                std::this_thread::sleep_for(FAILED_PAUSE);
+                continue;
+            }
+            failedInRow = 0;
+            auto acquired = std::chrono::system_clock::now();
+            if(Common::Constants::getMidpointTimestamps()) {
+                acquired -= std::chrono::duration_cast<std::chrono::system_clock::duration>((requestEnd - requestStart) / 2);
+            }
+            const size_t slot = taken % capacity;
+            for(size_t i = 0; i < items.size(); i++) {
+                memcpy(&samples[slot * sampleSize + offsets[i]], items[i].pdata, Common::S7Utils::DataSizeByte(items[i].WordLen));
+            }
+            times[slot] = acquired;
+            ++taken;
+        }
+        client.Disconnect();
+
+        const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, ("Burst done for PLC " + _ip + ", samples: " + std::to_string(taken)
+            + " in ms: " + std::to_string(elapsed) + " failed requests: " + std::to_string(failed)).c_str(),
+            ("kept: " + std::to_string(std::min<uint64_t>(taken, capacity))).c_str());
+        if(!_stop) {
+            Deliver(vars, items, samples, times, taken);
+        }
+    }
+
+    for(auto& item : items) {
+        delete[] static_cast<char*>(item.pdata);
+    }
+    _running = false;
+}
+
+bool RAMS7200Burst::Probe(TS7Client& client, std::vector<std::string>& vars, std::vector<TS7DataItem>& items)
+{
+    if(client.ReadMultiVars(items.data(), items.size()) != 0) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Burst first request failed for PLC:", _ip.c_str());
+        return false;
+    }
+    for(size_t i = items.size(); i-- > 0; ) {
+        if(items[i].Result != 0) {
+            Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Burst read refused by the PLC, skipping:", vars[i].c_str());
+            delete[] static_cast<char*>(items[i].pdata);
+            items.erase(items.begin() + i);
+            vars.erase(vars.begin() + i);
+        }
+    }
+    if(items.empty()) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "No address left to sample for PLC:", _ip.c_str());
+        return false;
+    }
+    return true;
+}
+
+void RAMS7200Burst::Deliver(const std::vector<std::string>& vars, const std::vector<TS7DataItem>& items, const std::vector<char>& samples,
+    const std::vector<std::chrono::system_clock::time_point>& times, uint64_t taken)
+{
+    const size_t capacity = times.size();
+    const size_t kept = std::min<uint64_t>(taken, capacity);
+    if(kept == 0) {
+        return;
+    }
+    // Oldest sample first: once the ring has wrapped, it is the one the next sample would replace
+    const size_t first = taken > capacity ? taken % capacity : 0;
+    const size_t sampleSize = samples.size() / capacity;
+    const auto acquired = times[first];
+
+    toDPBatch batch;
+    size_t offset = 0;
+    for(size_t i = 0; i < items.size(); i++) {
+        const size_t size = Common::S7Utils::DataSizeByte(items[i].WordLen);
+        char* payload = new char[1 + kept * size];
+        payload[0] = SampleKind(items[i].WordLen);
+        for(size_t n = 0; n < kept; n++) {
+            memcpy(payload + 1 + n * size, &samples[((first + n) % capacity) * sampleSize + offset], size);
+        }
+        batch.emplace_back(_ipCombo + "$" + vars[i] + "$_burst", static_cast<uint16_t>(1 + kept * size), payload, acquired);
+        offset += size;
+    }
+
+    char* payload = new char[1 + kept * sizeof(int64_t)];
+    payload[0] = 'T';
+    for(size_t n = 0; n < kept; n++) {
+        const int64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(times[(first + n) % capacity].time_since_epoch()).count();
+        memcpy(payload + 1 + n * sizeof(int64_t), &ms, sizeof(int64_t));
+    }
+    batch.emplace_back(_ipCombo + "$_burstTimes", static_cast<uint16_t>(1 + kept * sizeof(int64_t)), payload, acquired);
+
+    _queueBatchToDPCB(batch);
+}
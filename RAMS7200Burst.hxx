@@ -0,0 +1,79 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RAMS7200LibFacade.hxx"
+
+/**
+ * @brief Burst sampling of a PLC: reads a few addresses back to back on a connection of its own,
+ * for a given time, into a ring buffer of the last burstSamples samples. At the end, every address
+ * gets its samples as one dyn value (`<IP_COMBO>$<var>$_burst`) and the PLC the read times of the
+ * samples (`<IP_COMBO>$_burstTimes`), queued as one batch.
+ *
+ * The payloads are for RAMS7200BurstTrans: one kind byte (X, B, W or D: the S7 size of the
+ * address, T: times) followed by the samples, oldest first. Samples are raw S7 values, times
+ * are milliseconds since the epoch in host order.
+ */
+class RAMS7200Burst
+{
+public:
+    /**
+     * @param ip : PLC IP
+     * @param ipCombo : prefix of the DP addresses of the PLC
+     * @param queueBatchToDPCallback : queues the values of the burst at once
+     */
+    RAMS7200Burst(const std::string& ip, const std::string& ipCombo, queueBatchToDPCallback);
+    RAMS7200Burst(const RAMS7200Burst&) = delete;
+    RAMS7200Burst& operator=(const RAMS7200Burst&) = delete;
+    /**
+     * @brief Stops a running burst, without delivering it
+     */
+    ~RAMS7200Burst();
+
+    /**
+     * @brief Starts sampling the addresses in a thread, for duration
+     * @return false if a burst of this PLC is still running
+     */
+    bool start(const std::vector<std::string>& vars, std::chrono::milliseconds duration);
+    /**
+     * @brief Asks a running burst to stop after its current request, without delivering it. Does not wait.
+     */
+    void stop() {_stop = true;}
+
+private:
+    void Run(std::vector<std::string> vars, std::chrono::milliseconds duration);
+    /**
+     * @brief First request of a burst: the addresses refused by the PLC are left out, so that they do not
+     * fail every sample
+     * @return false if the request failed or no address is left
+     */
+    bool Probe(TS7Client& client, std::vector<std::string>& vars, std::vector<TS7DataItem>& items);
+    /**
+     * @brief Queues the kept samples of every item and their times
+     */
+    void Deliver(const std::vector<std::string>& vars, const std::vector<TS7DataItem>& items, const std::vector<char>& samples,
+        const std::vector<std::chrono::system_clock::time_point>& times, uint64_t taken);
+
+    const std::string _ip;
+    const std::string _ipCombo;
+    queueBatchToDPCallback _queueBatchToDPCB;
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _stop{false};
+    std::thread _thread;
+};
@@ -0,0 +1,66 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200Deadband.hxx"
+
+#include <cmath>
+#include <cstdlib>
+
+bool RAMS7200Deadband::parse(const std::string& field, RAMS7200Deadband& deadband)
+{
+    if(field.compare(0, 2, "db") != 0) {
+        return false;
+    }
+    const char* text = field.c_str() + 2;
+    char* end;
+    deadband.amount = strtod(text, &end);
+    if(end == text || !(deadband.amount >= 0)) {
+        return false;
+    }
+    deadband.relative = *end == '%';
+    if(deadband.relative) {
+        ++end;
+    }
+    deadband.hysteresis = 0;
+    if(*end == 'h') {
+        text = end + 1;
+        deadband.hysteresis = strtod(text, &end);
+        if(end == text || !(deadband.hysteresis >= 0)) {
+            return false;
+        }
+    }
+    deadband.field = field;
+    return *end == '\0';
+}
+
+bool RAMS7200Deadband::passes(double last, double value, int& direction) const
+{
+    if(std::isnan(last) || std::isnan(value)) {
+        // Delivered when it becomes or stops being a number
+        return std::isnan(last) != std::isnan(value);
+    }
+    const double delta = value - last;
+    const int sign = (delta > 0) - (delta < 0);
+    if(sign == 0) {
+        return false;
+    }
+    const double scale = relative ? std::fabs(last) / 100 : 1;
+    double band = amount * scale;
+    if(direction != 0 && sign != direction) {
+        band += hysteresis * scale;
+    }
+    if(std::fabs(delta) <= band) {
+        return false;
+    }
+    direction = sign;
+    return true;
+}
@@ -0,0 +1,41 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <string>
+
+/**
+ * @brief Deadband of an address, from the last field of `<IP_COMBO>$<var>$<poll>$db<amount>[%][h<hysteresis>]`.
+ * A value is delivered when it differs from the last delivered one by more than the amount. With a
+ * hysteresis, a change in the opposite direction of the last delivered change needs amount + hysteresis,
+ * so that a value flickering around a level is delivered once.
+ */
+struct RAMS7200Deadband
+{
+    double amount;
+    double hysteresis;
+    bool relative;      // amount and hysteresis in percent of the last delivered value
+    int wordLen;        // S7 word length of the address, to decode its values
+    std::string field;  // as in the address
+
+    /**
+     * @return false if the field is not db<amount>[%][h<hysteresis>]
+     */
+    static bool parse(const std::string& field, RAMS7200Deadband& deadband);
+
+    /**
+     * @param direction : sign of the last delivered change, 0 if none, updated when the value passes
+     * @return true if value is to be delivered
+     */
+    bool passes(double last, double value, int& direction) const;
+};
@@ -0,0 +1,222 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200DeliveryQueue.hxx"
+#include "Common/Logger.hxx"
+#include "Common/Trace.hxx"
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+RAMS7200DeliveryQueue::~RAMS7200DeliveryQueue()
+{
+    for(auto& item : _queue) {
+        delete[] std::get<2>(item);
+    }
+    if(_journal) {
+        fclose(_journal);
+    }
+}
+
+void RAMS7200DeliveryQueue::configure(size_t capacity, Overflow overflow, const std::string& journalPath)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    _capacity = capacity;
+    _overflow = overflow;
+    if(_capacity > 0 && _overflow == Overflow::JOURNAL) {
+        _journal = fopen(journalPath.c_str(), "w+b");
+        if(!_journal) {
+            Common::Logger::globalWarning(__PRETTY_FUNCTION__, ("Cannot open the delivery journal " + journalPath + ", dropping the oldest values instead:").c_str(), strerror(errno));
+            _overflow = Overflow::DROP_OLDEST;
+        }
+        _journalPath = journalPath;
+    }
+}
+
+RAMS7200DeliveryQueue::Overflow RAMS7200DeliveryQueue::overflowFromName(const std::string& name)
+{
+    if(name == "keepLatest") {
+        return Overflow::KEEP_LATEST;
+    }
+    if(name == "journal") {
+        return Overflow::JOURNAL;
+    }
+    if(name != "dropOldest") {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Unknown delivery overflow policy, using dropOldest:", name.c_str());
+    }
+    return Overflow::DROP_OLDEST;
+}
+
+void RAMS7200DeliveryQueue::push(CharString&& address, uint16_t length, char* payload)
+{
+    Common::Trace::Span span("enqueue"); // mostly waiting for workProc to release the queue
+    std::lock_guard<std::mutex> lock{_mutex};
+    enqueue(toDPEntry(std::move(address), length, payload, std::chrono::steady_clock::now(), std::chrono::system_clock::now()));
+}
+
+void RAMS7200DeliveryQueue::push(toDPBatch& batch)
+{
+    Common::Trace::Span span("enqueue batch");
+    std::lock_guard<std::mutex> lock{_mutex};
+    const auto now = std::chrono::steady_clock::now();
+    for(auto& value : batch) {
+        enqueue(toDPEntry(std::get<0>(value).c_str(), std::get<1>(value), std::get<2>(value), now, std::get<3>(value)));
+    }
+    batch.clear();
+}
+
+RAMS7200DeliveryQueue::Counters RAMS7200DeliveryQueue::counters()
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    return Counters{_queue.size() + _journaled, _dropped, _spilled};
+}
+
+std::unordered_set<std::string> RAMS7200DeliveryQueue::takeUndelivered()
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+    std::unordered_set<std::string> undelivered;
+    undelivered.swap(_undelivered);
+    return undelivered;
+}
+
+void RAMS7200DeliveryQueue::enqueue(toDPEntry&& entry)
+{
+    if(_capacity == 0) {
+        _queue.emplace_back(std::move(entry));
+        return;
+    }
+    // In order: once a value is in the journal, the next ones follow it there, or are dropped
+    if(_journaled > 0) {
+        if(!spill(entry)) {
+            drop(entry);
+        }
+        return;
+    }
+    if(_queue.size() < _capacity) {
+        if(_overflowing) {
+            _overflowing = false;
+            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, ("Delivery queue below its capacity again, dropped: " + std::to_string(_dropped)
+                + " spilled to the journal: " + std::to_string(_spilled)).c_str());
+        }
+    } else {
+        if(!_overflowing) {
+            _overflowing = true;
+            Common::Logger::globalWarning(__PRETTY_FUNCTION__, ("Delivery queue full, values: " + std::to_string(_capacity)).c_str());
+        }
+        if(_overflow == Overflow::KEEP_LATEST) {
+            const auto latest = _latest.find(static_cast<const char*>(std::get<0>(entry)));
+            if(latest != _latest.end()) {
+                // Same position and queue time, newer value: the DPE still gets the last value read
+                auto& queued = _queue[latest->second - _popped];
+                delete[] std::get<2>(queued);
+                std::get<1>(queued) = std::get<1>(entry);
+                std::get<2>(queued) = std::get<2>(entry);
+                std::get<4>(queued) = std::get<4>(entry);
+                ++_dropped;
+                return;
+            }
+        } else if(_overflow == Overflow::JOURNAL && spill(entry)) {
+            return;
+        }
+        auto oldest = std::move(_queue.front());
+        popFront(oldest);
+        drop(oldest);
+    }
+    if(_overflow == Overflow::KEEP_LATEST) {
+        _latest[static_cast<const char*>(std::get<0>(entry))] = _popped + _queue.size();
+    }
+    _queue.emplace_back(std::move(entry));
+}
+
+void RAMS7200DeliveryQueue::popFront(const toDPEntry& item)
+{
+    _queue.pop_front();
+    if(_overflow == Overflow::KEEP_LATEST) {
+        const auto latest = _latest.find(static_cast<const char*>(std::get<0>(item)));
+        if(latest != _latest.end() && latest->second == _popped) {
+            _latest.erase(latest);
+        }
+    }
+    ++_popped;
+}
+
+void RAMS7200DeliveryQueue::drop(const toDPEntry& entry)
+{
+    delete[] std::get<2>(entry);
+    ++_dropped;
+    _undelivered.emplace(static_cast<const char*>(std::get<0>(entry)));
+}
+
+// Journal record: address length, address, value length, value, acquisition time in ns since the epoch
+bool RAMS7200DeliveryQueue::spill(const toDPEntry& entry)
+{
+    const char* address = std::get<0>(entry);
+    const uint16_t addressLength = static_cast<uint16_t>(strlen(address));
+    const uint16_t length = std::get<1>(entry);
+    const int64_t acquired = std::chrono::duration_cast<std::chrono::nanoseconds>(std::get<4>(entry).time_since_epoch()).count();
+    if(fseek(_journal, 0, SEEK_END) != 0 ||
+       fwrite(&addressLength, sizeof(addressLength), 1, _journal) != 1 ||
+       fwrite(address, 1, addressLength, _journal) != addressLength ||
+       fwrite(&length, sizeof(length), 1, _journal) != 1 ||
+       fwrite(std::get<2>(entry), 1, length, _journal) != length ||
+       fwrite(&acquired, sizeof(acquired), 1, _journal) != 1) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Cannot write to the delivery journal:", strerror(errno));
+        return false;
+    }
+    delete[] std::get<2>(entry);
+    ++_journaled;
+    ++_spilled;
+    return true;
+}
+
+void RAMS7200DeliveryQueue::replay()
+{
+    if(_journaled == 0) {
+        return;
+    }
+    fflush(_journal);
+    if(fseek(_journal, _journalRead, SEEK_SET) != 0) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    std::string address;
+    while(_journaled > 0 && _queue.size() < _capacity) {
+        uint16_t addressLength, length;
+        int64_t acquired;
+        bool ok = fread(&addressLength, sizeof(addressLength), 1, _journal) == 1;
+        address.resize(ok ? addressLength : 0);
+        ok = ok && fread(&address[0], 1, addressLength, _journal) == addressLength && fread(&length, sizeof(length), 1, _journal) == 1;
+        char* payload = ok ? new char[length] : nullptr;
+        ok = ok && fread(payload, 1, length, _journal) == length && fread(&acquired, sizeof(acquired), 1, _journal) == 1;
+        if(!ok) {
+            delete[] payload;
+            Common::Logger::globalWarning(__PRETTY_FUNCTION__, ("Cannot read the delivery journal, values lost: " + std::to_string(_journaled)).c_str(), strerror(errno));
+            _dropped += _journaled;
+            _journaled = 0;
+            _undelivered.emplace("");
+            break;
+        }
+        --_journaled;
+        _queue.emplace_back(address.c_str(), length, payload, now,
+            std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(acquired))));
+    }
+    _journalRead = ftell(_journal);
+    if(_journaled == 0) {
+        // Everything is back in memory: start the file again
+        _journalRead = 0;
+        if(ftruncate(fileno(_journal), 0) != 0) {
+            Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Cannot truncate the delivery journal:", strerror(errno));
+        }
+        rewind(_journal);
+    }
+}
@@ -0,0 +1,141 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <CharString.hxx>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// address, length, payload, time queued, acquisition time (the original time of the value)
+using toDPEntry = std::tuple<CharString, uint16_t, char*, std::chrono::steady_clock::time_point, std::chrono::system_clock::time_point>;
+// address, length, payload, acquisition time
+using toDPBatch = std::vector<std::tuple<std::string, uint16_t, char*, std::chrono::system_clock::time_point>>;
+
+/**
+ * @brief Values on their way from the PLC threads to workProc, which forwards them to the DPEs.
+ * Lockable, to hold off the producers and workProc.
+ *
+ * Unbounded unless configured with a capacity. When full, a value:
+ *  - DROP_OLDEST: replaces the oldest queued value, which is dropped
+ *  - KEEP_LATEST: replaces the queued value of the same address in place, else the oldest one
+ *  - JOURNAL: goes to a file, like every value after it until the file is replayed. Each drain
+ *    moves up to capacity values back from the file, for the next drain. A value that cannot be
+ *    written to the file while older ones are in it is dropped, to keep the order.
+ * The addresses of the dropped values are kept for takeUndelivered(): their DPEs do not hold the
+ * last value read.
+ */
+class RAMS7200DeliveryQueue
+{
+public:
+    enum class Overflow {DROP_OLDEST, KEEP_LATEST, JOURNAL};
+
+    struct Counters
+    {
+        uint64_t buffered;  // values in memory and in the journal
+        uint64_t dropped;   // since start
+        uint64_t spilled;   // written to the journal since start
+    };
+
+    RAMS7200DeliveryQueue() = default;
+    RAMS7200DeliveryQueue(const RAMS7200DeliveryQueue&) = delete;
+    RAMS7200DeliveryQueue& operator=(const RAMS7200DeliveryQueue&) = delete;
+    ~RAMS7200DeliveryQueue();
+
+    /**
+     * @brief Bounds the queue, call before the first push
+     * @param capacity : values kept in memory, 0: unbounded
+     * @param journalPath : file of the JOURNAL policy, truncated. DROP_OLDEST is used if it cannot be opened.
+     */
+    void configure(size_t capacity, Overflow overflow, const std::string& journalPath = "");
+    /**
+     * @brief Overflow policy from its config file name: dropOldest, keepLatest or journal
+     */
+    static Overflow overflowFromName(const std::string& name);
+
+    /**
+     * @brief Queues a value acquired now
+     */
+    void push(CharString&& address, uint16_t length, char* payload);
+    /**
+     * @brief Queues the values at once, so that the same drain hands them all over. Takes the payloads.
+     */
+    void push(toDPBatch& batch);
+
+    /**
+     * @brief Hands every queued value, oldest first, to deliver(toDPEntry&, steady_clock::time_point) while
+     * holding the queue, with the time the queue was taken: no value queued after it. deliver takes
+     * ownership of the payload.
+     * @return number of values handed over
+     */
+    template <typename Deliver>
+    size_t drain(Deliver&& deliver)
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        const auto start = std::chrono::steady_clock::now();
+        const size_t drained = _queue.size();
+        while(!_queue.empty()) {
+            auto item = std::move(_queue.front());
+            popFront(item);
+            deliver(item, start);
+        }
+        replay();
+        return drained;
+    }
+
+    Counters counters();
+    /**
+     * @brief Addresses of the values dropped since the last call, an empty address when the addresses
+     * of lost values are unknown (unreadable journal)
+     */
+    std::unordered_set<std::string> takeUndelivered();
+
+    void lock() {_mutex.lock();}
+    void unlock() {_mutex.unlock();}
+
+private:
+    void enqueue(toDPEntry&& entry);
+    // Removes the front, moved to item
+    void popFront(const toDPEntry& item);
+    bool spill(const toDPEntry& entry);
+    void replay();
+    void drop(const toDPEntry& entry);
+
+    std::mutex _mutex;
+    std::deque<toDPEntry> _queue;
+
+    size_t _capacity{0};
+    Overflow _overflow{Overflow::DROP_OLDEST};
+    bool _overflowing{false};
+    uint64_t _dropped{0};
+    uint64_t _spilled{0};
+    std::unordered_set<std::string> _undelivered;
+
+    // KEEP_LATEST: sequence number of the queued value of each address, _popped is the one of the front
+    std::unordered_map<std::string, uint64_t> _latest;
+    uint64_t _popped{0};
+
+    // JOURNAL: values written and not read back yet, from _journalRead
+    FILE* _journal{nullptr};
+    std::string _journalPath;
+    long _journalRead{0};
+    uint64_t _journaled{0};
+};
@@ -194,6 +194,160 @@ int des_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetric_
     return CRYPT_OK;
 }
 
+/* Same rounds as desfunc on two blocks at once: the lookups of one block hide the latency of the other */
+static void desfunc2(unsigned int *block, const unsigned int *keys)
+{
+    unsigned int work0, work1, right0, right1, leftt0, leftt1;
+    long long unsigned int tmp;
+    int cur_round;
+
+    leftt0 = block[0];
+    right0 = block[1];
+    leftt1 = block[2];
+    right1 = block[3];
+
+#define DES_PERMUTE(tab, leftt, right)                                                     \
+    tmp = tab[0][LTC_BYTE(leftt, 0)] ^ tab[1][LTC_BYTE(leftt, 1)] ^                        \
+          tab[2][LTC_BYTE(leftt, 2)] ^ tab[3][LTC_BYTE(leftt, 3)] ^                        \
+          tab[4][LTC_BYTE(right, 0)] ^ tab[5][LTC_BYTE(right, 1)] ^                        \
+          tab[6][LTC_BYTE(right, 2)] ^ tab[7][LTC_BYTE(right, 3)];                         \
+    leftt = (unsigned int)(tmp >> 32);                                                     \
+    right = (unsigned int)(tmp & 0xFFFFFFFFUL)
+
+#define DES_F_ODD(work)  (SP7[(work) & 0x3fL] ^ SP5[((work) >> 8) & 0x3fL] ^ SP3[((work) >> 16) & 0x3fL] ^ SP1[((work) >> 24) & 0x3fL])
+#define DES_F_EVEN(work) (SP8[(work) & 0x3fL] ^ SP6[((work) >> 8) & 0x3fL] ^ SP4[((work) >> 16) & 0x3fL] ^ SP2[((work) >> 24) & 0x3fL])
+
+    DES_PERMUTE(des_ip, leftt0, right0);
+    DES_PERMUTE(des_ip, leftt1, right1);
+
+    for (cur_round = 0; cur_round < 8; cur_round++, keys += 4) {
+        work0 = RORc(right0, 4) ^ keys[0];
+        work1 = RORc(right1, 4) ^ keys[0];
+        leftt0 ^= DES_F_ODD(work0);
+        leftt1 ^= DES_F_ODD(work1);
+        work0 = right0 ^ keys[1];
+        work1 = right1 ^ keys[1];
+        leftt0 ^= DES_F_EVEN(work0);
+        leftt1 ^= DES_F_EVEN(work1);
+
+        work0 = RORc(leftt0, 4) ^ keys[2];
+        work1 = RORc(leftt1, 4) ^ keys[2];
+        right0 ^= DES_F_ODD(work0);
+        right1 ^= DES_F_ODD(work1);
+        work0 = leftt0 ^ keys[3];
+        work1 = leftt1 ^ keys[3];
+        right0 ^= DES_F_EVEN(work0);
+        right1 ^= DES_F_EVEN(work1);
+    }
+
+    DES_PERMUTE(des_fp, leftt0, right0);
+    DES_PERMUTE(des_fp, leftt1, right1);
+
+#undef DES_F_EVEN
+#undef DES_F_ODD
+#undef DES_PERMUTE
+
+    block[0] = right0;
+    block[1] = leftt0;
+    block[2] = right1;
+    block[3] = leftt1;
+}
+
+static void des_ecb_blocks(const unsigned char *in, unsigned char *out, unsigned long blocks, const unsigned int *keys)
+{
+    unsigned int work[4];
+
+    for (; blocks >= 2; blocks -= 2, in += 16, out += 16) {
+        LOAD32H(work[0], in+0);
+        LOAD32H(work[1], in+4);
+        LOAD32H(work[2], in+8);
+        LOAD32H(work[3], in+12);
+        desfunc2(work, keys);
+        STORE32H(work[0], out+0);
+        STORE32H(work[1], out+4);
+        STORE32H(work[2], out+8);
+        STORE32H(work[3], out+12);
+    }
+    if (blocks == 1) {
+        LOAD32H(work[0], in+0);
+        LOAD32H(work[1], in+4);
+        desfunc(work, keys);
+        STORE32H(work[0], out+0);
+        STORE32H(work[1], out+4);
+    }
+}
+
+int des_ecb_encrypt_blocks(const unsigned char *pt, unsigned char *ct, unsigned long blocks, const symmetric_key *skey)
+{
+    LTC_ARGCHK(pt   != NULL);
+    LTC_ARGCHK(ct   != NULL);
+    LTC_ARGCHK(skey != NULL);
+    des_ecb_blocks(pt, ct, blocks, skey->des.ek);
+    return CRYPT_OK;
+}
+
+int des_ecb_decrypt_blocks(const unsigned char *ct, unsigned char *pt, unsigned long blocks, const symmetric_key *skey)
+{
+    LTC_ARGCHK(pt   != NULL);
+    LTC_ARGCHK(ct   != NULL);
+    LTC_ARGCHK(skey != NULL);
+    des_ecb_blocks(ct, pt, blocks, skey->des.dk);
+    return CRYPT_OK;
+}
+
+int des_test(void)
+{
+    static const struct {
+        unsigned char key[8], pt[8], ct[8];
+    } cases[] = {
+        /* FIPS 81 / textbook vectors */
+        { { 0x13, 0x34, 0x57, 0x79, 0x9B, 0xBC, 0xDF, 0xF1 },
+          { 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF },
+          { 0x85, 0xE8, 0x13, 0x54, 0x0F, 0x0A, 0xB4, 0x05 } },
+        { { 0x0E, 0x32, 0x92, 0x32, 0xEA, 0x6D, 0x0D, 0x73 },
+          { 0x87, 0x87, 0x87, 0x87, 0x87, 0x87, 0x87, 0x87 },
+          { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 } },
+        /* Key and padding of the touch panel User file */
+        { { '1', '2', '3', 0, 0, 0, 0, 0 },
+          { 'a', 'd', 'm', 'i', 'n', ';', '1', '\n' },
+          { 0x01, 0xA4, 0x3A, 0x9A, 0xEF, 0x09, 0x9E, 0xEE } }
+    };
+    const unsigned long count = sizeof(cases) / sizeof(cases[0]);
+    unsigned char pt[8 * 5], ct[8 * 5], tmp[8];
+    symmetric_key skey;
+    unsigned long i, j;
+
+    for (i = 0; i < count; i++) {
+        if (des_setup(cases[i].key, 8, 0, &skey) != CRYPT_OK) {
+            return CRYPT_FAIL_TESTVECTOR;
+        }
+        des_ecb_encrypt(cases[i].pt, tmp, &skey);
+        if (memcmp(tmp, cases[i].ct, 8) != 0) {
+            return CRYPT_FAIL_TESTVECTOR;
+        }
+        des_ecb_decrypt(tmp, tmp, &skey);
+        if (memcmp(tmp, cases[i].pt, 8) != 0) {
+            return CRYPT_FAIL_TESTVECTOR;
+        }
+
+        /* Odd block count: exercises the pairs and the trailing single block */
+        for (j = 0; j < 5; j++) {
+            XMEMCPY(pt + 8 * j, cases[i].pt, 8);
+        }
+        des_ecb_encrypt_blocks(pt, ct, 5, &skey);
+        for (j = 0; j < 5; j++) {
+            if (memcmp(ct + 8 * j, cases[i].ct, 8) != 0) {
+                return CRYPT_FAIL_TESTVECTOR;
+            }
+        }
+        des_ecb_decrypt_blocks(ct, ct, 5, &skey);
+        if (memcmp(ct, pt, sizeof(pt)) != 0) {
+            return CRYPT_FAIL_TESTVECTOR;
+        }
+    }
+    return CRYPT_OK;
+}
+
 void des_done(symmetric_key *skey)
 {
   LTC_UNUSED_PARAM(skey);
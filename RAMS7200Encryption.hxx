@@ -1393,6 +1393,20 @@ void desfunc(unsigned int *block, const unsigned int *keys);
 
 int des_ecb_encrypt(const unsigned char *pt, unsigned char *ct, const symmetric_key *skey);
 int des_ecb_decrypt(const unsigned char *ct, unsigned char *pt, const symmetric_key *skey);
+
+/**
+   Multi-block ECB: same result as calling des_ecb_encrypt/des_ecb_decrypt on each 8-byte block,
+   blocks are processed in interleaved pairs to keep the S-box lookups of both in flight
+   @param blocks Number of 8-byte blocks in pt/ct (in place operation allowed)
+*/
+int des_ecb_encrypt_blocks(const unsigned char *pt, unsigned char *ct, unsigned long blocks, const symmetric_key *skey);
+int des_ecb_decrypt_blocks(const unsigned char *ct, unsigned char *pt, unsigned long blocks, const symmetric_key *skey);
+
+/**
+   Known answer test of the single and multi-block APIs
+   @return CRYPT_OK if all vectors pass, CRYPT_FAIL_TESTVECTOR otherwise
+*/
+int des_test(void);
 void des_done(symmetric_key *skey);
 
 #endif
@@ -19,9 +19,12 @@
 #include "Transformations/RAMS7200FloatTrans.hxx"
 #include "Transformations/RAMS7200BoolTrans.hxx"
 #include "Transformations/RAMS7200Uint8Trans.hxx"
+#include "Transformations/RAMS7200BurstTrans.hxx"
 #include "RAMS7200HWService.hxx"
+#include "RAMS7200LastValues.hxx"
 
 #include <algorithm>
+#include <unistd.h>
 #include <utility>
 #include "Common/Logger.hxx"
 #include "Common/Constants.hxx"
@@ -29,6 +32,8 @@
 #include "Common/S7Utils.hxx"
 #include <PVSSMacros.hxx>     // DEBUG macros
 
+// Poll time field of the addresses sampled by a burst: <IP_COMBO>$<var>$_burst
+static const std::string BURST_POLLTIME = "_burst";
 
 //--------------------------------------------------------------------------------
 // We get new configs here. Create a new HW-Object on arrival and insert it.
@@ -73,6 +78,10 @@ PVSSboolean RAMS7200HWMapper::addDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
       Common::Logger::globalInfo(Common::Logger::L3,"String transformation");
       confPtr->setTransform(new Transformations::RAMS7200StringTrans);
       break;
+    case RAMS7200DrvBurstTransType:
+      Common::Logger::globalInfo(Common::Logger::L3,"Burst transformation");
+      confPtr->setTransform(new Transformations::RAMS7200BurstTrans);
+      break;
     default:
       Common::Logger::globalError("RAMS7200HWMapper::addDpPa", CharString("Illegal transformation type ") + CharString((int) confPtr->getTransformationType()));
       return HWMapper::addDpPa(dpId, confPtr);
@@ -90,7 +99,7 @@ PVSSboolean RAMS7200HWMapper::addDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
 
   HWObject *hwObj = new HWObject;
   // Set Address and Subindex
-  Common::Logger::globalInfo(Common::Logger::L3, "New Object", "name:" + confPtr->getName());
+  LOGGER_INFO(Common::Logger::L3, "New Object", "name:" + confPtr->getName());
   hwObj->setConnectionId(confPtr->getConnectionId());
   hwObj->setAddress(confPtr->getName());       // Resolve the HW-Address, too
 
@@ -103,13 +112,26 @@ PVSSboolean RAMS7200HWMapper::addDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
   // Add it to the list
   addHWObject(hwObj);
 
-  if( (confPtr->getDirection() == DIRECTION_IN || confPtr->getDirection() == DIRECTION_INOUT) && (addressOptions.size() == 3) ) {
+  // IP + VAR + POLLTIME [+ OPTION]
+  if( (confPtr->getDirection() == DIRECTION_IN || confPtr->getDirection() == DIRECTION_INOUT) && (addressOptions.size() == 3 || addressOptions.size() == 4) ) {
     if(!Common::S7Utils::AddressIsValid(addressOptions[1])){
       Common::Logger::globalError(__PRETTY_FUNCTION__, "Address is not valid!", CharString(confPtr->getName()));
       return PVSS_FALSE;
     }
+    const std::string option = addressOptions.size() == 4 ? addressOptions[3] : "";
+    RAMS7200Aggregation aggregation;
+    RAMS7200Deadband deadband;
+    if(!option.empty() && ((!RAMS7200Aggregation::parse(option, aggregation) && !RAMS7200Deadband::parse(option, deadband))
+        || addressOptions[2] == BURST_POLLTIME || Common::S7Utils::AddressGetAmount(addressOptions[1]) != 1)) {
+      Common::Logger::globalError(__PRETTY_FUNCTION__, "Option is not valid, expected min<s>, max<s>, mean<s> or db<amount>[%][h<hysteresis>] of a number:", CharString(confPtr->getName()));
+      return PVSS_FALSE;
+    }
+    if(RAMS7200Aggregation::parse(option, aggregation) && !aggregation.supports(Common::S7Utils::AddressGetWordLen(addressOptions[1]))) {
+      Common::Logger::globalError(__PRETTY_FUNCTION__, "Mean of a bit or an integer is not supported, only of a REAL (D) address:", CharString(confPtr->getName()));
+      return PVSS_FALSE;
+    }
     // TODO: add warning if requested transformation is not the same as the s7 type
-    addAddress(addressOptions[0], addressOptions[1], addressOptions[2]);
+    addAddress(confPtr->getName().c_str(), addressOptions[0], addressOptions[1], addressOptions[2], option);
   }
 
   return PVSS_TRUE;
@@ -119,7 +141,7 @@ PVSSboolean RAMS7200HWMapper::addDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
 
 PVSSboolean RAMS7200HWMapper::clrDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
 {
-  Common::Logger::globalInfo(Common::Logger::L3, "clrDpPa called for" + confPtr->getName());
+  LOGGER_INFO(Common::Logger::L3, "clrDpPa called for" + confPtr->getName());
 
   std::vector<std::string> addressOptions = Common::Utils::split(confPtr->getName().c_str());
 
@@ -138,9 +160,9 @@ PVSSboolean RAMS7200HWMapper::clrDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
 
   if(confPtr->getDirection() == DIRECTION_IN || confPtr->getDirection() == DIRECTION_INOUT)
   {
-      if (addressOptions.size() == 3) // IP + VAR + POLLTIME
+      if (addressOptions.size() == 3 || addressOptions.size() == 4) // IP + VAR + POLLTIME [+ OPTION]
       {
-        removeAddress(addressOptions[0], addressOptions[1], addressOptions[2]);
+        removeAddress(confPtr->getName().c_str(), addressOptions[0], addressOptions[1], addressOptions[2], addressOptions.size() == 4 ? addressOptions[3] : "");
       }
   }
 
@@ -154,7 +176,13 @@ PVSSboolean RAMS7200HWMapper::clrDpPa(DpIdentifier &dpId, PeriphAddr *confPtr)
   return HWMapper::clrDpPa(dpId, confPtr);
 }
 
-void RAMS7200HWMapper::addAddress(const std::string &ip, const std::string &var, const std::string &pollTime)
+const RAMS7200WriteTarget* RAMS7200HWMapper::findWriteTarget(const std::string& address) const
+{
+  auto it = _writeTargets.find(address);
+  return it != _writeTargets.end() ? &(it->second) : nullptr;
+}
+
+void RAMS7200HWMapper::addAddress(const std::string &address, const std::string &ip, const std::string &var, const std::string &pollTime, const std::string &option)
 {
   auto msIt = RAMS7200MSs.find(ip);
   if(msIt == RAMS7200MSs.end())
@@ -170,13 +198,21 @@ void RAMS7200HWMapper::addAddress(const std::string &ip, const std::string &var,
   if(!msIt->second._run.load() && _newMSCB){
       _newMSCB(msIt->second);
   }
-  if(Common::S7Utils::AddressIsValid(var))
-    msIt->second.addVar(var, std::stoi(pollTime));   
+  if(pollTime == BURST_POLLTIME) {
+    msIt->second.addBurstVar(var);
+  } else if(Common::S7Utils::AddressIsValid(var)) {
+    auto msVar = msIt->second.addVar(var, std::stoi(pollTime), option);
+    // Aggregated and filtered addresses are read only
+    if(option.empty()) {
+      _writeTargets[address] = RAMS7200WriteTarget{&msIt->second, msVar};
+    }
+  }
 }
 
 
-void RAMS7200HWMapper::removeAddress(const std::string &ip, const std::string &var, const std::string &pollTime)
+void RAMS7200HWMapper::removeAddress(const std::string &address, const std::string &ip, const std::string &var, const std::string &pollTime, const std::string &option)
 {
+  _writeTargets.erase(address);
   auto msIt = RAMS7200MSs.find(ip);
   if(msIt != RAMS7200MSs.end()) {
     {
@@ -184,9 +220,28 @@ void RAMS7200HWMapper::removeAddress(const std::string &ip, const std::string &v
         msIt->second._run.store(false);
     }
     msIt->second._threadCv.notify_all();
-    msIt->second.removeVar(var);
+    if(pollTime == BURST_POLLTIME) {
+      msIt->second.removeBurstVar(var);
+    } else if(!option.empty()) {
+      msIt->second.removeVar(var, option);
+    } else {
+      // Several addresses (i.e. different poll times) can share the same variable slot
+      const auto msVar = msIt->second.findVar(var);
+      for(auto it = _writeTargets.begin(); msVar && it != _writeTargets.end(); ) {
+        if(it->second.var == msVar)
+          it = _writeTargets.erase(it);
+        else
+          ++it;
+      }
+      msIt->second.removeVar(var);
+    }
     if(msIt->second.isEmpty()) {
       Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,  "All Addresses deleted for IP  Combo PLC;TP : " + CharString(ip.c_str()));
+      // No value left to restore for this PLC
+      const auto lastValues = RAMS7200LastValues::path(msIt->second._ip_combo);
+      if(!lastValues.empty()) {
+        unlink(lastValues.c_str());
+      }
       RAMS7200MSs.erase(msIt);
     }
   }
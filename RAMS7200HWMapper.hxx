@@ -27,9 +27,20 @@
 #define RAMS7200DrvInt32TransType (TransUserType + 3)
 #define RAMS7200DrvFloatTransType (TransUserType + 4)
 #define RAMS7200DrvStringTransType (TransUserType + 5)
+#define RAMS7200DrvBurstTransType (TransUserType + 6)
 
 using newMSCB = std::function<void(RAMS7200MS&)>;
 
+/**
+ * @brief Resolved destination of a PLC write: the MS and the variable slot inside it.
+ * Both pointers stay valid until the address is removed in clrDpPa (node based containers).
+ */
+struct RAMS7200WriteTarget
+{
+    RAMS7200MS* ms;
+    RAMS7200MSVar* var;
+};
+
 class RAMS7200HWMapper : public HWMapper
 {
   public:
@@ -38,11 +49,14 @@ class RAMS7200HWMapper : public HWMapper
 
     std::unordered_map<std::string, RAMS7200MS>& getRAMS7200MSs(){return RAMS7200MSs;}
     void setNewMSCallback(newMSCB cb){_newMSCB = cb;}
+    const RAMS7200WriteTarget* findWriteTarget(const std::string& address) const;
 
   private:
-    void addAddress(const std::string &ip, const std::string &var, const std::string &pollTime);
-    void removeAddress(const std::string& ip, const std::string& var, const std::string &pollTime);
+    void addAddress(const std::string &address, const std::string &ip, const std::string &var, const std::string &pollTime, const std::string &option);
+    void removeAddress(const std::string &address, const std::string& ip, const std::string& var, const std::string &pollTime, const std::string &option);
     std::unordered_map<std::string, RAMS7200MS> RAMS7200MSs;
+    // HWObject address -> write target, filled in addDpPa so that writeData does not need to parse addresses
+    std::unordered_map<std::string, RAMS7200WriteTarget> _writeTargets;
     newMSCB _newMSCB{nullptr};
 
     enum Direction
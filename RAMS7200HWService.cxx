@@ -15,12 +15,14 @@
 
 #include <RAMS7200HWService.hxx>
 #include "RAMS7200Resources.hxx"
+#include "RAMS7200Adapter.hxx"
 
 #include <DrvManager.hxx>
 #include <PVSSMacros.hxx>     // DEBUG macros
 #include "Common/Logger.hxx"
 #include "Common/Constants.hxx"
 #include "Common/Utils.hxx"
+#include "Common/Trace.hxx"
 
 #include "RAMS7200HWMapper.hxx"
 #include "RAMS7200LibFacade.hxx"
@@ -31,6 +33,8 @@
 #include <chrono>
 #include <utility>
 #include <thread>
+#include <sstream>
+#include <algorithm>
 
 static std::atomic<bool> _driverRun{true};
 
@@ -48,6 +52,28 @@ PVSSboolean RAMS7200HWService::initialize(int argc, char *argv[])
   // if you don't need it, you can safely remove the whole method
   Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"RAMS7200 Driver initialization of Internal vars start");
 
+  // keep PLC and panel threads off the ErrHdl path if configured
+  Common::Logger::startAsync(Common::Constants::getAsyncLogQueueSize());
+
+  // opt-in span recording, dumped on cycle overruns and on _TRACEDUMP
+  Common::Trace::enable(Common::Constants::getTraceEvents());
+  Common::Trace::setThreadName("workProc");
+
+  // values waiting for workProc, bounded if configured
+  _toDPqueue.configure(Common::Constants::getDeliveryQueueSize(),
+    RAMS7200DeliveryQueue::overflowFromName(Common::Constants::getDeliveryOverflow()),
+    Common::Constants::getJournalPath() + "RAMS7200_" + std::to_string(Common::Constants::getDrvNo()) + "_journal.bin");
+
+  // redundancy state for the PLC and panel threads
+  RAMS7200Adapter::setDisableCommands([]() -> bool { return RAMS7200Resources::getDisableCommands(); });
+
+  // all touch panels are served by a single thread
+  _panelLoop.start();
+
+  // config DPEs handled with the driver state
+  Common::Constants::setParseCallback("_LATENCYDUMP", [this](const char*) { this->dumpLatencies(); });
+  Common::Constants::setParseCallback("_BURST", [this](const char* data) { this->startBurst(data); });
+
   // add callback for new MS
   static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->setNewMSCallback(_newMSCB);
 
@@ -59,55 +85,27 @@ PVSSboolean RAMS7200HWService::initialize(int argc, char *argv[])
 
 void RAMS7200HWService::queueToDP(const std::string& dp_address, uint16_t length, char* payload)
 {
-  insertInDataToDp(dp_address.c_str(), length, payload);
+  _toDPqueue.push(dp_address.c_str(), length, payload);
 }
 
 void RAMS7200HWService::handleNewMS(RAMS7200MS& ms)
 {
-  std::lock_guard<std::mutex> lock{_toDPmutex};
+  std::lock_guard<RAMS7200DeliveryQueue> lock{_toDPqueue};
   ms._run = true;
 
   // PLC thread
   _plcThreads.emplace_back(std::thread([&]() {
     Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Thread up for PLC IP" + CharString(ms._ip.c_str()));
     
-    RAMS7200LibFacade aFacade(ms, this->_queueToDPCB);
-    aFacade.Connect();
-    bool wasActive = !RAMS7200Resources::getDisableCommands();
-    while(_driverRun && ms._run)
-    {
-      const bool isNowActive = !RAMS7200Resources::getDisableCommands();
-      aFacade.EnsureConnection(wasActive != isNowActive);
-      if(isNowActive) {
-        // The Server is Active (for redundant systems)
-        Common::Logger::globalInfo(Common::Logger::L2,__PRETTY_FUNCTION__, "Polling:", ms._ip.c_str());
-        const auto cycleInterval = std::chrono::seconds(1); //TODO : this should be a driver parameter? Constant + Driver start read-up
-        const auto start = std::chrono::steady_clock::now();
-        //First do all the writes for this IP, then the reads
-        aFacade.WriteToPLC();
-        aFacade.Poll();                         
-        const auto end = std::chrono::steady_clock::now();
-        const auto time_elapsed = end - start;
-        
-        // If we still have time left, then sleep
-        if(time_elapsed < cycleInterval)
-          aFacade.sleep_for(cycleInterval- time_elapsed);
-      } else {
-        // The Server is Passive (for redundant systems)
-        aFacade.sleep_for( std::chrono::seconds(1));
-      }
-      wasActive = isNowActive;
-    }
+    Common::Trace::setThreadName("PLC " + ms._ip_combo);
+    RAMS7200LibFacade aFacade(ms, this->_queueToDPCB, this->_queueBatchToDPCB);
+    aFacade.Run(_driverRun);
   }));
 
-  // Panel thread. Check if we've got a panel IP
+  // Panel file sharing. Check if we've got a panel IP
   if(!ms._tp_ip.empty()) 
   {
-    _panelThreads.emplace_back(std::thread([&]() {
-      Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Thread up for PANEL IP:" + CharString(ms._tp_ip.c_str()));
-      RAMS7200Panel aPanel(ms, this->_queueToDPCB);
-      aPanel.FileSharingTask(Common::Constants::getMsCopyPort());
-    }));
+    _panelLoop.addPanel(ms);
   }
   else
   {
@@ -121,6 +119,7 @@ void RAMS7200HWService::handleNewMS(RAMS7200MS& ms)
 PVSSboolean RAMS7200HWService::start()
 {
   // use this function to start your hardware activity.  
+  _startTime = std::chrono::steady_clock::now();
   // The ms list is automatically built by exisiting addresses sent at driver startup
   for (auto& msIt : static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs() )
   {
@@ -144,6 +143,11 @@ void RAMS7200HWService::stop()
   Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__,"RAMS7200 Driver requested to Stop");
   _driverRun.store(false);
 
+  // running bursts are dropped: they stop after their current request, while the PLC threads stop
+  for(auto& burst : _bursts) {
+    burst.second->stop();
+  }
+
   for (auto& msIt : static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs() )
   {
       msIt.second._run.store(false);
@@ -156,11 +160,11 @@ void RAMS7200HWService::stop()
         pt.join();
   }
 
-  for(auto& pt : _panelThreads)
-  {
-    if(pt.joinable())
-        pt.join();
-  }
+  _bursts.clear();
+  _panelLoop.stop();
+
+  // all producers are stopped: forward what is still queued
+  Common::Logger::stopAsync();
 }
 
 //--------------------------------------------------------------------------------
@@ -168,13 +172,33 @@ void RAMS7200HWService::stop()
 void RAMS7200HWService::workProc()
 {
 
+  // Queued below, so before taking the lock
+  RAMS7200Stats::publishGlobalIfDue(_queueToDPCB, _toDPqueue);
+
   HWObject obj;
-  std::lock_guard<std::mutex> lock{_toDPmutex};
 
-  while (!_toDPqueue.empty())
+  // Queue latency per PLC: consecutive items usually come from the same PLC
+  auto& MSs = static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs();
+  std::string lastIpCombo;
+  RAMS7200MS* lastMS = nullptr;
+  std::chrono::steady_clock::time_point drainStart;
+  // Values that did not reach their DPE, reported to their PLC with those dropped by the queue
+  std::vector<std::string> undelivered;
+
+  const size_t drained = _toDPqueue.drain([&](toDPEntry& item, std::chrono::steady_clock::time_point now)
   {
-    auto item = std::move(_toDPqueue.front());
-    _toDPqueue.pop();
+    drainStart = now;
+    const char* address = std::get<0>(item);
+    const char* ipEnd = strchr(address, '$');
+    const size_t ipLength = ipEnd ? ipEnd - address : strlen(address);
+    if(lastIpCombo.compare(0, std::string::npos, address, ipLength) != 0) {
+      lastIpCombo.assign(address, ipLength);
+      auto msIt = MSs.find(lastIpCombo);
+      lastMS = msIt != MSs.end() ? &msIt->second : nullptr;
+    }
+    if(lastMS) {
+      lastMS->_stats.queueLatency(now - std::get<3>(item));
+    }
 
     obj.setAddress(std::get<0>(item));
     
@@ -185,24 +209,85 @@ void RAMS7200HWService::workProc()
     if ( addrObj )
     {
         //addrObj->debugPrint();
-        obj.setOrgTime(TimeVar());  // current time
+        // acquisition time: S7 response, or middle of the request (midpointTimestamps)
+        const auto acquired = std::chrono::duration_cast<std::chrono::milliseconds>(std::get<4>(item).time_since_epoch()).count();
+        obj.setOrgTime(TimeVar(acquired / 1000, acquired % 1000));
         obj.setDlen(std::get<1>(item)); //length
         obj.setData((PVSSchar*)(std::move(std::get<2>(item)))); //data
         obj.setObjSrcType(srcPolled);
 
         if( DrvManager::getSelfPtr()->toDp(&obj, addrObj) != PVSS_TRUE) {
           Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Problem in sending item's value to PVSS for address: " + std::get<0>(item));
+          undelivered.emplace_back(address);
+        } else if(lastMS && !lastMS->_firstValueDelivered && ipEnd && ipEnd[1] != '_') {
+          // PLC variable, not an internal DPE like $_Stats
+          lastMS->_firstValueDelivered = true;
         }
+    } else if(address[0] == '_' || (ipEnd && ipEnd[1] == '_')) {
+        // Internal DPE ($_stat..., _lat..., _queue...) published whether configured or not
+        LOGGER_INFO(Common::Logger::L2, __PRETTY_FUNCTION__, "No DPE for internal address:", address);
+        delete[] std::get<2>(item);
     } else {
         Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Problem in getting HWObject for the address: " + std::get<0>(item));   
+        undelivered.emplace_back(address);
+        delete[] std::get<2>(item);
     }
+  });
+  for(const auto& address : _toDPqueue.takeUndelivered()) {
+    undelivered.push_back(address);
+  }
+  reportUndelivered(undelivered);
+  if(drained > 0) {
+    Common::Trace::record("workProc drain", drainStart, std::chrono::steady_clock::now(), drained);
+  }
+  if(!_startupReported) {
+    reportStartup();
   }
 }
 
-void RAMS7200HWService::insertInDataToDp(CharString&& address, uint16_t length, char* item)
+void RAMS7200HWService::reportUndelivered(const std::vector<std::string>& addresses)
 {
-    std::lock_guard<std::mutex> lock{_toDPmutex};
-    _toDPqueue.emplace(std::move(address), length, std::move(item));
+  auto& MSs = static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs();
+  for(const auto& address : addresses) {
+    const auto ipEnd = address.find('$');
+    if(address.empty()) {
+      // Lost from the journal, addresses unknown
+      for(auto& msIt : MSs) {
+        msIt.second.valueUndelivered(address);
+      }
+    } else if(ipEnd != std::string::npos && address.compare(ipEnd + 1, 1, "_") != 0) {
+      // PLC variable: internal DPEs have no last value
+      auto msIt = MSs.find(address.substr(0, ipEnd));
+      if(msIt != MSs.end()) {
+        msIt->second.valueUndelivered(address);
+      }
+    }
+  }
+}
+
+void RAMS7200HWService::reportStartup()
+{
+  auto& MSs = static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs();
+  if(MSs.empty() || _startTime == std::chrono::steady_clock::time_point()) {
+    return;
+  }
+  size_t delivered = 0;
+  std::string unreachable;
+  for(auto& msIt : MSs) {
+    const auto& ms = msIt.second;
+    if(ms._firstValueDelivered) {
+      delivered++;
+    } else if(ms._firstConnect == RAMS7200MS::FirstConnect::FAILED) {
+      unreachable += " " + ms._ip;
+    } else {
+      // Not tried yet, or connected and no values yet
+      return;
+    }
+  }
+  _startupReported = true;
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - _startTime).count();
+  Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, ("Startup: first values of " + std::to_string(delivered) + "/" + std::to_string(MSs.size())
+    + " PLCs delivered in ms: " + std::to_string(elapsed)).c_str(), unreachable.empty() ? "" : ("unreachable:" + unreachable).c_str());
 }
 
 //--------------------------------------------------------------------------------
@@ -210,7 +295,16 @@ void RAMS7200HWService::insertInDataToDp(CharString&& address, uint16_t length,
 
 PVSSboolean RAMS7200HWService::writeData(HWObject *objPtr)
 {
-  Common::Logger::globalInfo(Common::Logger::L2,__PRETTY_FUNCTION__,"Incoming obj address",objPtr->getAddress());
+  LOGGER_INFO(Common::Logger::L2,__PRETTY_FUNCTION__,"Incoming obj address",objPtr->getAddress());
+
+  // PLC addresses are resolved once in addDpPa: one lookup and we can queue the write
+  const auto target = static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->findWriteTarget(objPtr->getAddress().c_str());
+  if(target)
+  {
+    target->ms->queuePLCItem(*target->var, copyWriteData(objPtr));
+    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Added write request to queue for Address: " + CharString(objPtr->getAddress()) + " : "+ CharString(objPtr->getInfo()) );
+    return PVSS_TRUE;
+  }
 
   std::vector<std::string> addressOptions = Common::Utils::split(objPtr->getAddress().c_str());
 
@@ -248,21 +342,7 @@ PVSSboolean RAMS7200HWService::writeData(HWObject *objPtr)
       return PVSS_FALSE;
     }
 
-    const auto length = static_cast<int>(objPtr->getDlen());
-    auto correctval = new char[length];
-    std::memcpy(correctval, objPtr->getDataPtr(), length);
-
-    if(length == 2) {
-      int16_t inInt16 = Common::Utils::CopyNSwapBytes<int16_t>(correctval);
-      Common::Logger::globalInfo(Common::Logger::L2, "Received request to write integer, Correct val is: ", std::to_string(inInt16).c_str());
-    } else if(length == 4){
-      float inFloat = Common::Utils::CopyNSwapBytes<float>(correctval);
-      Common::Logger::globalInfo(Common::Logger::L2, "Received request to write float, Correct val is:  ", std::to_string(inFloat).c_str());
-    } else {
-      Common::Logger::globalInfo(Common::Logger::L2, "Received request to write non integer/float: ", reinterpret_cast<const char*>(correctval), reinterpret_cast<const char*>(correctval) + length);
-    }
-
-    msIt->second.queuePLCItem(addressOptions[ADDRESS_OPTIONS_VAR], correctval);
+    msIt->second.queuePLCItem(addressOptions[ADDRESS_OPTIONS_VAR], copyWriteData(objPtr));
     Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Added write request to queue for Address: " + CharString(objPtr->getAddress()) + " : "+ CharString(objPtr->getInfo()) );
   }
   else
@@ -273,6 +353,64 @@ PVSSboolean RAMS7200HWService::writeData(HWObject *objPtr)
   return PVSS_TRUE;
 }
 
+void RAMS7200HWService::startBurst(const std::string& request)
+{
+  std::stringstream ss(request);
+  std::string ip;
+  long duration = 0;
+  ss >> ip >> duration;
+  auto& MSs = static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs();
+  auto msIt = std::find_if(MSs.begin(), MSs.end(), [&ip](const std::pair<const std::string, RAMS7200MS>& ms) {
+    return ms.first == ip || ms.second._ip == ip;
+  });
+  if(msIt == MSs.end() || duration <= 0) {
+    Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Invalid burst request, expected <PLC IP> <ms>:", request.c_str());
+    return;
+  }
+  const auto vars = msIt->second.burstVars();
+  if(vars.empty()) {
+    Common::Logger::globalWarning(__PRETTY_FUNCTION__, "No address to sample, add DPEs addressed <IP_COMBO>$<var>$_burst for PLC:", ip.c_str());
+    return;
+  }
+  auto& burst = _bursts[msIt->first];
+  if(!burst) {
+    burst.reset(new RAMS7200Burst(msIt->second._ip, msIt->first, _queueBatchToDPCB));
+  }
+  if(!burst->start(vars, std::chrono::milliseconds(duration))) {
+    Common::Logger::globalWarning(__PRETTY_FUNCTION__, "A burst is already running for PLC:", ip.c_str());
+  }
+}
+
+void RAMS7200HWService::dumpLatencies()
+{
+  RAMS7200Stats::globalLatencies().dump("Driver");
+  for (auto& msIt : static_cast<RAMS7200HWMapper*>(DrvManager::getHWMapperPtr())->getRAMS7200MSs() )
+  {
+      msIt.second._stats.latencies().dump("PLC " + msIt.first);
+  }
+}
+
+char* RAMS7200HWService::copyWriteData(HWObject *objPtr)
+{
+  const auto length = static_cast<int>(objPtr->getDlen());
+  auto correctval = new char[length];
+  std::memcpy(correctval, objPtr->getDataPtr(), length);
+
+  if(!Common::Logger::isEnabled(Common::Logger::L2)) {
+    return correctval;
+  }
+  if(length == 2) {
+    int16_t inInt16 = Common::Utils::CopyNSwapBytes<int16_t>(correctval);
+    Common::Logger::globalInfo(Common::Logger::L2, "Received request to write integer, Correct val is: ", std::to_string(inInt16).c_str());
+  } else if(length == 4){
+    float inFloat = Common::Utils::CopyNSwapBytes<float>(correctval);
+    Common::Logger::globalInfo(Common::Logger::L2, "Received request to write float, Correct val is:  ", std::to_string(inFloat).c_str());
+  } else {
+    Common::Logger::globalInfo(Common::Logger::L2, "Received request to write non integer/float: ", reinterpret_cast<const char*>(correctval), reinterpret_cast<const char*>(correctval) + length);
+  }
+  return correctval;
+}
+
 //--------------------------------------------------------------------------------
 void handleSegfault(int signal_code){
     void *array[50];
@@ -19,17 +19,16 @@
 #include <HWService.hxx>
 #include "RAMS7200MS.hxx"
 #include "RAMS7200LibFacade.hxx"
-#include "RAMS7200Panel.hxx"
+#include "RAMS7200PanelLoop.hxx"
+#include "RAMS7200DeliveryQueue.hxx"
+#include "RAMS7200Burst.hxx"
 #include "Common/Logger.hxx"
+#include "Common/Constants.hxx"
 
 #include <memory>
-#include <queue>
 #include <chrono>
 #include <thread>
 #include <unordered_map>
-#include <tuple>
-
-using toDPTriple = std::tuple<CharString, uint16_t, char*>;
 
 class RAMS7200HWService : public HWService
 {
@@ -45,14 +44,24 @@ class RAMS7200HWService : public HWService
 private:
     void queueToDP(const std::string&, uint16_t, char*);
     void handleNewMS(RAMS7200MS&);
+    char* copyWriteData(HWObject *objPtr);
+    void dumpLatencies();
+    void reportStartup();
+    /**
+     * @brief Tells the PLCs which of their values did not reach the DPEs, "": all of them
+     */
+    void reportUndelivered(const std::vector<std::string>& addresses);
+    /**
+     * @brief Starts the burst requested on _BURST: "<PLC IP> <ms>"
+     */
+    void startBurst(const std::string& request);
 
     queueToDPCallback  _queueToDPCB{[this](const std::string& dp_address, uint16_t length, char* payload){this->queueToDP(dp_address, length, payload);}};
+    queueBatchToDPCallback _queueBatchToDPCB{[this](toDPBatch& batch){this->_toDPqueue.push(batch);}};
     std::function<void(RAMS7200MS&)> _newMSCB{[this](RAMS7200MS& ms){this->handleNewMS(ms);}};
 
     //Common
-    void insertInDataToDp(CharString&& address, uint16_t length, char* value);
-    std::mutex _toDPmutex;
-    std::queue<toDPTriple> _toDPqueue;
+    RAMS7200DeliveryQueue _toDPqueue;
 
     enum
     {
@@ -63,7 +72,13 @@ private:
     } ADDRESS_OPTIONS;
 
     std::vector<std::thread> _plcThreads;
-    std::vector<std::thread> _panelThreads;
+    // Burst sampling per IP_COMBO, created on the first request
+    std::unordered_map<std::string, std::unique_ptr<RAMS7200Burst>> _bursts;
+
+    // Startup KPI: time from start() until every reachable PLC delivered its first values
+    std::chrono::steady_clock::time_point _startTime;
+    bool _startupReported{false};
+    RAMS7200PanelLoop _panelLoop{_queueToDPCB, static_cast<int>(Common::Constants::getMsCopyPort())};
 };
 
 
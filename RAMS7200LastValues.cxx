@@ -0,0 +1,180 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200LastValues.hxx"
+#include "Common/Constants.hxx"
+#include "Common/Logger.hxx"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = {'R', 'A', 'M', 'S', 'L', 'V', '0', '1'};
+static const size_t INITIAL_SIZE = 64 * 1024;
+
+RAMS7200LastValues::~RAMS7200LastValues()
+{
+    close();
+}
+
+bool RAMS7200LastValues::open(const std::string& path)
+{
+    close();
+    _fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    struct stat st;
+    if(_fd < 0 || fstat(_fd, &st) != 0 || !map(std::max(static_cast<size_t>(st.st_size), INITIAL_SIZE))) {
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, ("Cannot map the last values file " + path + ":").c_str(), strerror(errno));
+        close();
+        return false;
+    }
+
+    Header* h = header();
+    if(memcmp(h->magic, MAGIC, sizeof(MAGIC)) != 0 || h->recordSize != sizeof(Record) || h->used > _size - sizeof(Header)) {
+        memcpy(h->magic, MAGIC, sizeof(MAGIC));
+        h->recordSize = sizeof(Record);
+        h->used = 0;
+    }
+    size_t offset = 0;
+    while(offset + sizeof(Record) <= h->used) {
+        Record* r = record(offset);
+        if(r->capacity > h->used - offset - sizeof(Record) || r->length > r->capacity || r->address[sizeof(r->address) - 1] != '\0') {
+            // Damaged tail, e.g. power cut during an append
+            h->used = offset;
+            break;
+        }
+        r->status |= RESTORED;
+        // A record appended later for the same address (longer value) replaces the first one; erased ones are skipped
+        if(r->address[0] != '\0') {
+            _offsets[r->address] = offset;
+        }
+        offset += sizeof(Record) + r->capacity;
+    }
+    return true;
+}
+
+void RAMS7200LastValues::store(const std::string& address, const char* value, uint32_t length, std::chrono::system_clock::time_point readTime)
+{
+    if(!_map) {
+        return;
+    }
+    Record* r = nullptr;
+    const auto it = _offsets.find(address);
+    if(it != _offsets.end() && record(it->second)->capacity >= length) {
+        r = record(it->second);
+    } else {
+        if(address.size() >= sizeof(r->address)) {
+            return;
+        }
+        const uint32_t capacity = (std::max<uint32_t>(length, 1) + 7) / 8 * 8;
+        const size_t offset = header()->used;
+        const size_t needed = sizeof(Header) + offset + sizeof(Record) + capacity;
+        if(needed > _size && !map(std::max(_size * 2, needed))) {
+            return;
+        }
+        r = record(offset);
+        memset(r, 0, sizeof(Record));
+        memcpy(r->address, address.c_str(), address.size() + 1);
+        r->capacity = capacity;
+        // Counted once complete: a torn append is dropped by open()
+        header()->used = offset + sizeof(Record) + capacity;
+        _offsets[address] = offset;
+    }
+    memcpy(r->value(), value, length);
+    r->length = length;
+    r->timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(readTime.time_since_epoch()).count();
+    r->status = FRESH;
+}
+
+void RAMS7200LastValues::failed(const std::string& address, int result)
+{
+    const auto it = _offsets.find(address);
+    if(_map && it != _offsets.end()) {
+        Record* r = record(it->second);
+        r->status = static_cast<uint32_t>(result) | (r->status & UNDELIVERED);
+    }
+}
+
+void RAMS7200LastValues::undelivered(const std::string& address)
+{
+    const auto it = _offsets.find(address);
+    if(_map && it != _offsets.end()) {
+        record(it->second)->status |= UNDELIVERED;
+    }
+}
+
+void RAMS7200LastValues::erase(const std::string& address)
+{
+    if(!_map || _offsets.erase(address) == 0) {
+        return;
+    }
+    // The shorter records replaced by a later one are still in the file: all of them go
+    for(size_t offset = 0; offset + sizeof(Record) <= header()->used; offset += sizeof(Record) + record(offset)->capacity) {
+        if(address == record(offset)->address) {
+            record(offset)->address[0] = '\0';
+        }
+    }
+}
+
+void RAMS7200LastValues::clear()
+{
+    if(_map) {
+        header()->used = 0;
+    }
+    _offsets.clear();
+}
+
+bool RAMS7200LastValues::map(size_t size)
+{
+    if(ftruncate(_fd, size) != 0) {
+        return false;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+    if(mapped == MAP_FAILED) {
+        return false;
+    }
+    if(_map) {
+        munmap(_map, _size);
+    }
+    _map = static_cast<char*>(mapped);
+    _size = size;
+    return true;
+}
+
+void RAMS7200LastValues::close()
+{
+    if(_map) {
+        munmap(_map, _size);
+        _map = nullptr;
+        _size = 0;
+    }
+    if(_fd >= 0) {
+        ::close(_fd);
+        _fd = -1;
+    }
+    _offsets.clear();
+}
+
+std::string RAMS7200LastValues::path(const std::string& ipCombo)
+{
+    const auto& dir = Common::Constants::getLastValuePath();
+    if(dir.empty()) {
+        return "";
+    }
+    // PLC;TP: the ';' is not portable in a file name
+    std::string name = ipCombo;
+    std::replace(name.begin(), name.end(), ';', '_');
+    return dir + "RAMS7200_" + std::to_string(Common::Constants::getDrvNo()) + "_" + name + ".lv";
+}
@@ -0,0 +1,117 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Last raw value, read time and status of each address of a PLC, in a memory-mapped file
+ * that survives a driver restart. Written from the poll path of the PLC thread: not thread safe.
+ *
+ * The file is a header followed by fixed records, each with room for its value rounded up to
+ * 8 bytes. Records are only appended; erase() blanks the address of a record, clear() forgets them all.
+ */
+class RAMS7200LastValues
+{
+public:
+    enum Status : uint32_t
+    {
+        FRESH = 0,          // read by this driver process
+        RESTORED = 1u << 31,    // loaded from the file at startup, not read since
+        UNDELIVERED = 1u << 30  // dropped on its way to the DPE, not restored
+        // other values: snap7 result of the last failed read, the value is the last good one
+    };
+
+    struct Record
+    {
+        char address[64];   // DP address, nul terminated
+        uint32_t capacity;  // bytes reserved for the value
+        uint32_t length;    // bytes of the value
+        int64_t timestamp;  // read time, ms since the epoch
+        uint32_t status;
+        uint32_t reserved;
+        // followed by the value
+        const char* value() const {return reinterpret_cast<const char*>(this + 1);}
+        char* value() {return reinterpret_cast<char*>(this + 1);}
+    };
+
+    RAMS7200LastValues() = default;
+    RAMS7200LastValues(const RAMS7200LastValues&) = delete;
+    RAMS7200LastValues& operator=(const RAMS7200LastValues&) = delete;
+    ~RAMS7200LastValues();
+
+    /**
+     * @brief Maps the file, created if needed. The records of a file with another layout are dropped.
+     * Every record found is marked RESTORED.
+     * @return false if the file cannot be mapped, the store is then disabled
+     */
+    bool open(const std::string& path);
+    bool isOpen() const {return _map != nullptr;}
+
+    /**
+     * @brief Calls f(const Record&) for every record
+     */
+    template <typename F>
+    void forEach(F&& f) const
+    {
+        for(const auto& offset : _offsets) {
+            f(*record(offset.second));
+        }
+    }
+
+    /**
+     * @brief Stores a good value read at the given time. Addresses longer than 63 characters are not stored.
+     */
+    void store(const std::string& address, const char* value, uint32_t length, std::chrono::system_clock::time_point readTime);
+    /**
+     * @brief Keeps the value of the address and records the snap7 result of a failed read
+     */
+    void failed(const std::string& address, int result);
+    /**
+     * @brief Marks the value of the address as not in its DPE, until the next store
+     */
+    void undelivered(const std::string& address);
+    /**
+     * @brief Forgets the value of a removed address. Its records stay in the file with an empty address.
+     */
+    void erase(const std::string& address);
+    void clear();
+
+    /**
+     * @param ipCombo : PLC;TP IP combo of the PLC thread, two PLC threads never share a file
+     * @return the file of a PLC in lastValuePath, empty if the last values are not kept
+     */
+    static std::string path(const std::string& ipCombo);
+
+private:
+    struct Header
+    {
+        char magic[8];
+        uint32_t recordSize;
+        uint32_t used;      // bytes of records after the header
+    };
+
+    Record* record(size_t offset) const {return reinterpret_cast<Record*>(_map + sizeof(Header) + offset);}
+    Header* header() const {return reinterpret_cast<Header*>(_map);}
+    bool map(size_t size);
+    void close();
+
+    int _fd{-1};
+    char* _map{nullptr};
+    size_t _size{0};
+    std::unordered_map<std::string, size_t> _offsets;
+};
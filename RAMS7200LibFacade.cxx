@@ -15,18 +15,25 @@
 #include <csignal>
 
 #include "RAMS7200LibFacade.hxx"
-#include "RAMS7200Resources.hxx"
+#include "RAMS7200Adapter.hxx"
 #include "Common/Constants.hxx"
 #include "Common/Logger.hxx"
+#include "Common/Trace.hxx"
 #include <thread>
 #include <algorithm>
+#include <limits>
+#include <random>
 #include <vector>
 #include <sstream>
 #include <algorithm>
 
+// Writes then reads of a PLC, every second
+static const std::chrono::milliseconds CYCLE_INTERVAL{1000};
+// Failed requests in a row before reconnecting
+static const int MAX_IO_FAILURES = 5;
 
-RAMS7200LibFacade::RAMS7200LibFacade(RAMS7200MS& ms, queueToDPCallback cb)
-    : ms(ms), _queueToDPCB(cb)
+RAMS7200LibFacade::RAMS7200LibFacade(RAMS7200MS& ms, queueToDPCallback cb, queueBatchToDPCallback batchCb)
+    : ms(ms), _queueToDPCB(cb), _queueBatchToDPCB(batchCb)
 {
      Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Initialized LibFacade with PLC IP: "+ CharString(ms._ip.c_str()));
 }
@@ -37,26 +44,34 @@ void RAMS7200LibFacade::EnsureConnection(bool reduSwitch) {
     if(reduSwitch) {
         RAMS7200MarkDeviceConnectionError(!_client->Connected());
     }
-    if(_client->Connected() && ioFailures < 5){ // TODO: parameterize this : No, COnstant + Driver Start read
+    if(_client->Connected() && ioFailures < MAX_IO_FAILURES){ // TODO: parameterize this : No, COnstant + Driver Start read
         return;
     } else {
         if (_wasConnected) {
             Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Snap7: Connection lost with PLC IP: ", ms._ip.c_str());
-            if(!RAMS7200Resources::getDisableCommands()) {
+            if(!RAMS7200Adapter::getDisableCommands()) {
                 RAMS7200MarkDeviceConnectionError(true);
             }
         }
+        // Exponential backoff from 1 s to reconnectMax, with jitter so that the PLCs lost together
+        // (switch, power cut) are not all retried at the same time
+        std::chrono::milliseconds reconnectDelay{1000};
+        const std::chrono::milliseconds reconnectMax{std::max<uint32_t>(1, Common::Constants::getReconnectMax()) * 1000};
         do {
             //Disconnect and try to connect again.
+            ms._stats.reconnect();
             Disconnect();
             Connect();
 
             if(!_client->Connected()) {
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Failure in re-connection. Trying again in 5 seconds for PLC IP:" + CharString(ms._ip.c_str()));
-                sleep_for(std::chrono::seconds(5));
+                std::uniform_int_distribution<long> jitter(0, reconnectDelay.count() / 2);
+                const std::chrono::milliseconds delay{reconnectDelay.count() / 2 + jitter(_random)};
+                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Failure in re-connection. Trying again in ms: " + CharString(static_cast<int>(delay.count())), ms._ip.c_str());
+                sleep_for(delay);
+                reconnectDelay = std::min(reconnectDelay * 2, reconnectMax);
             }
         } while(ms._run && !_wasConnected);
-        if(!RAMS7200Resources::getDisableCommands()) {
+        if(!RAMS7200Adapter::getDisableCommands()) {
             RAMS7200MarkDeviceConnectionError(false);
         }
     }
@@ -64,15 +79,29 @@ void RAMS7200LibFacade::EnsureConnection(bool reduSwitch) {
 
 void RAMS7200LibFacade::Connect()
 {
+    Common::Trace::Span span("connect");
     Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Snap7: Connecting to : Local TSAP Port : Remote TSAP Port'", (ms._ip + " : "+ std::to_string(Common::Constants::getLocalTsapPort()) + ":" + std::to_string(Common::Constants::getRemoteTsapPort())).c_str());
 
     _client.reset(new TS7Client());
 
     _client->SetConnectionParams(ms._ip.c_str(), Common::Constants::getLocalTsapPort(), Common::Constants::getRemoteTsapPort());
+    uint16_t port = Common::Constants::getPlcPort();
+    _client->SetParam(p_u16_RemotePort, &port);
+    int32_t connectTimeout = Common::Constants::getConnectTimeout(ms._ip);
+    if(connectTimeout > 0) {
+        _client->SetParam(p_i32_PingTimeout, &connectTimeout);
+    }
+    int32_t ioTimeout = Common::Constants::getIoTimeout(ms._ip);
+    if(ioTimeout > 0) {
+        _client->SetParam(p_i32_SendTimeout, &ioTimeout);
+        _client->SetParam(p_i32_RecvTimeout, &ioTimeout);
+    }
     if(_client->Connect() == 0) {
         _wasConnected = true;
+        // The values may have changed while disconnected
+        _refreshPending = true;
     }
-    if (!RAMS7200Resources::getDisableCommands()) {
+    if (!RAMS7200Adapter::getDisableCommands()) {
         RAMS7200MarkDeviceConnectionError(!_client->Connected());
     }
 }
@@ -87,40 +116,280 @@ void RAMS7200LibFacade::Disconnect()
 }
 
 
-void RAMS7200LibFacade::Poll()
+void RAMS7200LibFacade::Run(const std::atomic<bool>& driverRun)
+{
+    RestoreLastValues();
+    ForgetAddresses();
+    Connect();
+    ms._firstConnect = _client->Connected() ? RAMS7200MS::FirstConnect::CONNECTED : RAMS7200MS::FirstConnect::FAILED;
+    bool wasActive = !RAMS7200Adapter::getDisableCommands();
+    auto nextKeepAlive = std::chrono::steady_clock::now();
+    while(driverRun && ms._run)
+    {
+      const bool isNowActive = !RAMS7200Adapter::getDisableCommands();
+      const auto switchover = std::chrono::steady_clock::now();
+      if(isNowActive != wasActive) {
+        // The other host delivers while this one is passive: the last values say nothing about the DPEs
+        _lastValues.clear();
+        _lastValueStore.clear();
+        _deadbandDirections.clear();
+        _refreshPending = isNowActive;
+      }
+      EnsureConnection(wasActive != isNowActive);
+      if(isNowActive) {
+        // The Server is Active (for redundant systems)
+        LOGGER_INFO(Common::Logger::L2,__PRETTY_FUNCTION__, "Polling:", ms._ip.c_str());
+        const auto cycleInterval = CYCLE_INTERVAL; //TODO : this should be a driver parameter? Constant + Driver start read-up
+        const auto start = std::chrono::steady_clock::now();
+        //First do all the writes for this IP, then the reads
+        WriteToPLC();
+        if(_refreshPending) {
+          _refreshPending = false;
+          Refresh();
+        } else {
+          Poll();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const auto time_elapsed = end - start;
+        UpdateStats(time_elapsed, time_elapsed > cycleInterval);
+        Common::Trace::record("cycle", start, end);
+        if(time_elapsed > cycleInterval && Common::Trace::isEnabled()) {
+          // The spans of the other PLCs are included: one file per minute at most
+          Common::Trace::dump("overrun", std::chrono::seconds(60));
+        }
+        if(!wasActive) {
+          Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Switched to active, first cycle done in ms: "
+            + CharString(static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(end - switchover).count())), ms._ip.c_str());
+        }
+
+        // If we still have time left, then sleep
+        if(time_elapsed < cycleInterval)
+          sleep_for(cycleInterval- time_elapsed);
+      } else if(Common::Constants::getWarmStandby() > 0) {
+        // The Server is Passive, warm standby: the connection is kept alive and the redundancy
+        // state is checked every 10 ms, so the first active cycle follows the switchover
+        bool alive = true;
+        if(std::chrono::steady_clock::now() >= nextKeepAlive) {
+          alive = KeepAlive();
+          nextKeepAlive = std::chrono::steady_clock::now() + std::chrono::seconds(Common::Constants::getWarmStandby());
+        }
+        if(alive) {
+          WaitWhilePassive(nextKeepAlive);
+        }
+      } else {
+        // The Server is Passive (for redundant systems)
+        sleep_for( std::chrono::seconds(1));
+      }
+      wasActive = isNowActive;
+    }
+}
+
+bool RAMS7200LibFacade::KeepAlive()
+{
+    // One byte of the V area: an idle connection may be dropped by the PLC or a firewall
+    uint8_t byte;
+    const auto start = std::chrono::steady_clock::now();
+    const int result = _client->ReadArea(S7AreaDB, 1, 0, 1, S7WLByte, &byte);
+    Common::Trace::record("keepalive", start, std::chrono::steady_clock::now());
+    if(result != 0) {
+        // Only one read per warmStandby seconds: the connection is renewed right away, not after MAX_IO_FAILURES periods
+        ioFailures = MAX_IO_FAILURES;
+        Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Keepalive read failed, reconnecting to PLC IP:", ms._ip.c_str());
+        return false;
+    }
+    return true;
+}
+
+void RAMS7200LibFacade::WaitWhilePassive(std::chrono::steady_clock::time_point until)
+{
+    while(ms._run && RAMS7200Adapter::getDisableCommands() && std::chrono::steady_clock::now() < until) {
+        sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void RAMS7200LibFacade::Refresh()
+{
+    const auto start = std::chrono::steady_clock::now();
+    toDPBatch batch;
+    _refreshBatch = &batch;
+    _refreshUnchanged = 0;
+    Poll(true);
+    _refreshBatch = nullptr;
+
+    const size_t changed = batch.size();
+    QueueValues(batch);
+    Common::Trace::record("refresh", start, std::chrono::steady_clock::now(), changed);
+    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, ("Full refresh: " + std::to_string(changed) + " values queued, "
+        + std::to_string(_refreshUnchanged) + " unchanged for PLC IP:").c_str(), ms._ip.c_str());
+}
+
+void RAMS7200LibFacade::RestoreLastValues()
+{
+    const auto path = RAMS7200LastValues::path(ms._ip_combo);
+    if(path.empty() || !_lastValueStore.open(path)) {
+        return;
+    }
+    if(RAMS7200Adapter::getDisableCommands()) {
+        _lastValueStore.clear();
+        return;
+    }
+    size_t restored = 0;
+    int64_t oldest = std::numeric_limits<int64_t>::max();
+    _lastValueStore.forEach([&](const RAMS7200LastValues::Record& record) {
+        if(record.status & RAMS7200LastValues::UNDELIVERED) {
+            return;
+        }
+        _lastValues[record.address].assign(record.value(), record.length);
+        oldest = std::min(oldest, record.timestamp);
+        restored++;
+    });
+    if(restored > 0) {
+        const auto age = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count() - oldest / 1000;
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, ("Restored " + std::to_string(restored) + " last values, oldest read s ago: "
+            + std::to_string(age)).c_str(), ms._ip.c_str());
+    }
+}
+
+void RAMS7200LibFacade::ForgetAddresses()
+{
+    std::vector<std::string> removed, undelivered;
+    {
+        std::lock_guard<std::mutex> lock{ms._rwmutex};
+        removed.swap(ms._removedAddresses);
+        undelivered.swap(ms._undeliveredAddresses);
+    }
+    for(const auto& address : removed) {
+        _lastValues.erase(address);
+        _lastValueStore.erase(address);
+        _aggregators.erase(address);
+        _deadbandDirections.erase(address);
+    }
+    // The DPE does not hold the last value read: the next refresh or deadband comparison must not count on it
+    for(const auto& address : undelivered) {
+        if(address.empty()) {
+            _lastValues.clear();
+            _lastValueStore.clear();
+            _deadbandDirections.clear();
+            break;
+        }
+        _lastValues.erase(address);
+        _lastValueStore.undelivered(address);
+        _deadbandDirections.erase(address);
+    }
+}
+
+void RAMS7200LibFacade::DeliverRead(const dpItem& item, char* payload, std::chrono::system_clock::time_point acquired, toDPBatch& values)
+{
+    for(const auto& aggregation : item.aggregations) {
+        const std::string address = item.dpAddress + "$" + aggregation.field;
+        char result[sizeof(float)];
+        std::chrono::system_clock::time_point windowStart;
+        if(_aggregators[address].add(aggregation, payload, acquired, result, windowStart)) {
+            char* value = new char[item.dpSize];
+            std::memcpy(value, result, item.dpSize);
+            values.emplace_back(address, item.dpSize, value, windowStart);
+        }
+    }
+    // Compared with the last delivered value, a refresh too: the DPE holds a value within the deadband
+    for(const auto& deadband : item.deadbands) {
+        const std::string address = item.dpAddress + "$" + deadband.field;
+        auto& lastValue = _lastValues[address];
+        const double value = RAMS7200Aggregator::decode(deadband.wordLen, payload);
+        if(lastValue.size() == static_cast<size_t>(item.dpSize)
+            && !deadband.passes(RAMS7200Aggregator::decode(deadband.wordLen, lastValue.data()), value, _deadbandDirections[address])) {
+            if(_refreshBatch) {
+                ++_refreshUnchanged;
+            }
+            continue;
+        }
+        lastValue.assign(payload, item.dpSize);
+        _lastValueStore.store(address, payload, item.dpSize, acquired);
+        char* filtered = new char[item.dpSize];
+        std::memcpy(filtered, payload, item.dpSize);
+        values.emplace_back(address, item.dpSize, filtered, acquired);
+    }
+    if(!item.raw) {
+        delete[] payload;
+        return;
+    }
+
+    auto& lastValue = _lastValues[item.dpAddress];
+    _lastValueStore.store(item.dpAddress, payload, item.dpSize, acquired);
+    // Full refresh: a value identical to the last delivered (or restored) one is still in its DPE
+    if(_refreshBatch && lastValue.size() == static_cast<size_t>(item.dpSize) && std::memcmp(lastValue.data(), payload, item.dpSize) == 0) {
+        delete[] payload;
+        ++_refreshUnchanged;
+        return;
+    }
+    lastValue.assign(payload, item.dpSize);
+    values.emplace_back(item.dpAddress, item.dpSize, payload, acquired);
+}
+
+void RAMS7200LibFacade::QueueValues(toDPBatch& values)
+{
+    if(_queueBatchToDPCB) {
+        _queueBatchToDPCB(values);
+    } else {
+        // The acquisition time is lost: the values are stamped when queued
+        for(auto& value : values) {
+            _queueToDPCB(std::get<0>(value), std::get<1>(value), std::get<2>(value));
+        }
+    }
+    values.clear();
+}
+
+void RAMS7200LibFacade::Poll(bool all)
 {
+    ForgetAddresses();
     if(ms.vars.empty()){
         Common::Logger::globalWarning(__PRETTY_FUNCTION__, "No addresses for PLC IP:", ms._ip.c_str());
         return;
     }
     auto pollStartTime = std::chrono::steady_clock::now();
-    Common::Logger::globalInfo(Common::Logger::L3,__PRETTY_FUNCTION__, ms._ip.c_str());
+    LOGGER_INFO(Common::Logger::L3,__PRETTY_FUNCTION__, ms._ip.c_str());
     std::vector<dpItem> addressesToPoll;
     std::vector<TS7DataItem> items;
     const auto pollInterval = Common::Constants::getPollingInterval();
     {
         std::lock_guard<std::mutex> lock{ms._rwmutex};
+        Common::Trace::record("rwmutex wait", pollStartTime, std::chrono::steady_clock::now());
+        std::vector<RAMS7200MSVar*> due;
         for(auto& var : ms.vars) {
-            const auto fpollTime = var.second.pollTime > pollInterval ? var.second.pollTime : pollInterval;
-            const auto tDiff =  std::chrono::duration_cast<std::chrono::seconds>(pollStartTime - var.second.lastPollTime).count();
-            if(tDiff >= fpollTime) {
-                var.second.lastPollTime = std::chrono::steady_clock::now();
-                addressesToPoll.emplace_back(dpItem{
-                    ms._ip_combo + "$" + var.second.varName + "$" + std::to_string(var.second.pollTime),
-                    Common::S7Utils::GetByteSizeFromAddress(var.second.varName),
-                });
-                items.emplace_back(var.second._toDP);
-                Common::S7Utils::TS7AllocateDataItemForAddress(items.back());
-                var.second._toDP.pdata = nullptr;
+            const auto fpollTime = std::chrono::seconds(var.second.pollTime > pollInterval ? var.second.pollTime : pollInterval);
+            // Due within half a cycle: cycles start a little more or less than CYCLE_INTERVAL apart, a poll time
+            // is rounded to the nearest number of cycles instead of the next one (1 s tags every 2 s)
+            if(all || pollStartTime - var.second.lastPollTime + CYCLE_INTERVAL / 2 >= fpollTime) {
+                due.push_back(&var.second);
             }
         }
+        if(all) {
+            // Full refresh: the shortest poll times, the most dynamic values, are read and delivered first
+            std::stable_sort(due.begin(), due.end(), [](const RAMS7200MSVar* a, const RAMS7200MSVar* b) {
+                return a->pollTime < b->pollTime;
+            });
+        }
+        for(auto var : due) {
+            var->lastPollTime = pollStartTime;
+            addressesToPoll.emplace_back(dpItem{
+                ms._ip_combo + "$" + var->varName + "$" + std::to_string(var->pollTime),
+                Common::S7Utils::GetByteSizeFromAddress(var->varName),
+                pollStartTime,
+                var->_raw,
+                var->_aggregations,
+                var->_deadbands
+            });
+            items.emplace_back(var->_toDP);
+            Common::S7Utils::TS7AllocateDataItemForAddress(items.back());
+            var->_toDP.pdata = nullptr;
+        }
     }
+    Common::Trace::record("plan read", pollStartTime, std::chrono::steady_clock::now(), items.size());
     if(!addressesToPoll.empty()) {
         RAMS7200ReadWriteMaxN(addressesToPoll, items, 19, PDU_SIZE, OVERHEAD_READ_VARIABLE, OVERHEAD_READ_MESSAGE, Common::S7Utils::Operation::READ);
     }
     else
     {
-        Common::Logger::globalInfo(Common::Logger::L3, "No vars to poll at the moment");
+        LOGGER_INFO(Common::Logger::L3, "No vars to poll at the moment");
     }
 
 }
@@ -128,13 +397,19 @@ void RAMS7200LibFacade::Poll()
 void RAMS7200LibFacade::WriteToPLC() {
     std::vector<dpItem> addresses;
     std::vector<TS7DataItem> items;
+    const auto planStart = std::chrono::steady_clock::now();
     {
         std::lock_guard<std::mutex> lock{ms._rwmutex};
+        Common::Trace::record("rwmutex wait", planStart, std::chrono::steady_clock::now());
         for(auto& var : ms.vars) {
             if(var.second._toPlc.pdata != nullptr){
                 addresses.emplace_back(dpItem{
                     ms._ip_combo + "$" + var.second.varName + "$" + std::to_string(var.second.pollTime),
                     Common::S7Utils::GetByteSizeFromAddress(var.second.varName),
+                    var.second._toPlcQueued,
+                    true,
+                    {},
+                    {}
                 });
                 items.emplace_back(var.second._toPlc);
                 var.second._toPlc.pdata = nullptr;
@@ -143,16 +418,23 @@ void RAMS7200LibFacade::WriteToPLC() {
             }
         }
     }
+    Common::Trace::record("plan write", planStart, std::chrono::steady_clock::now(), items.size());
     if(!addresses.empty()){
         RAMS7200ReadWriteMaxN(addresses, items, 10, PDU_SIZE, OVERHEAD_WRITE_VARIABLE, OVERHEAD_WRITE_MESSAGE, Common::S7Utils::Operation::WRITE);
     }
     else
     {
-        Common::Logger::globalInfo(Common::Logger::L3, "No vars to write at the moment");
+        LOGGER_INFO(Common::Logger::L3, "No vars to write at the moment");
     }
 }
 
 
+void RAMS7200LibFacade::UpdateStats(std::chrono::steady_clock::duration cycleDuration, bool overrun)
+{
+    ms._stats.cycle(cycleDuration, overrun);
+    ms._stats.publishIfDue(ms._ip_combo, _queueToDPCB, ioFailures);
+}
+
 void RAMS7200LibFacade::RAMS7200MarkDeviceConnectionError(bool error_status){
     Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, std::to_string(error_status).c_str(), CharString("PLC IP: ") + CharString(ms._ip_combo.c_str())) ;
     
@@ -169,22 +451,11 @@ void RAMS7200LibFacade::RAMS7200ReadWriteMaxN(std::vector<dpItem> dpItems, std::
         uint last_index = 0;
         uint to_send = 0;
         while(last_index < items.size()) {
-            to_send = 0;
-            curr_sum = 0;
-            
-            for (auto it = items.begin() + last_index; it != items.end(); ++it) {
-                const auto& var = *it;
-                const auto dataSize = Common::S7Utils::DataSizeByte(var.WordLen) * var.Amount;
-                const auto itemSize = dataSize + VAR_OH;
-                if (curr_sum + itemSize < PDU_SZ - MSG_OH && to_send < N) {
-                    curr_sum += itemSize;
-                    ++to_send;
-                } else {
-                    break;
-                }
-            }
+            to_send = Common::S7Utils::ItemsInRequest(&items[last_index], items.size() - last_index, N, PDU_SZ, VAR_OH, MSG_OH, curr_sum);
 
-            if(to_send == 0) {
+            const auto requestStart = std::chrono::steady_clock::now();
+            const bool direct = to_send == 0;
+            if(direct) {
                 //This means that the current variable has a mem size > PDU. Call with ReadArea because it can split the request automatically (PDU Independance)
                 to_send += 1;
                 const auto& last_item = items[last_index];
@@ -203,31 +474,67 @@ void RAMS7200LibFacade::RAMS7200ReadWriteMaxN(std::vector<dpItem> dpItems, std::
                 }
             }
 
-            std::stringstream addresses;
+            const auto requestEnd = std::chrono::steady_clock::now();
+            const bool isWrite = rorw == Common::S7Utils::Operation::WRITE;
+            if(Common::Trace::isEnabled()) {
+                const char* requestName = isWrite ? (direct ? "WriteArea" : "WriteMultiVars") : (direct ? "ReadArea" : "ReadMultiVars");
+                Common::Trace::record(requestName, requestStart, requestEnd, to_send);
+            }
+            ms._stats.s7RoundTrip(requestEnd - requestStart);
+            ms._stats.request(to_send, curr_sum + MSG_OH, PDU_SZ, isWrite, retOpt == 0);
+            // Acquisition time of the values read: the response, or the middle of the round trip
+            auto acquired = std::chrono::system_clock::now();
+            if(Common::Constants::getMidpointTimestamps()) {
+                acquired -= std::chrono::duration_cast<std::chrono::system_clock::duration>((requestEnd - requestStart) / 2);
+            }
+            // Result checks, accounting and hand over to the _toDPqueue, one push per request
+            const auto scatterStart = std::chrono::steady_clock::now();
+            toDPBatch requestValues;
+            toDPBatch& values = _refreshBatch ? *_refreshBatch : requestValues;
             for(uint i = last_index; i < last_index + to_send; i++) {
-                Common::Logger::globalInfo(Common::Logger::L4, dpItems[i].dpAddress.c_str(), Common::S7Utils::DisplayTS7DataItem(&items[i], rorw).c_str());
+                LOGGER_INFO(Common::Logger::L4, dpItems[i].dpAddress.c_str(), Common::S7Utils::DisplayTS7DataItem(&items[i], rorw).c_str());
+                if(retOpt == 0) {
+                    ms._stats.itemTransferred(Common::S7Utils::DataSizeByte(items[i].WordLen) * items[i].Amount, isWrite, items[i].Result == 0);
+                    if(isWrite && items[i].Result == 0) {
+                        ms._stats.writeAcknowledged(requestEnd - dpItems[i].requested);
+                    }
+                }
                 if(rorw == Common::S7Utils::Operation::READ){
                     if(items[i].Result == 0){
-                        this->_queueToDPCB(dpItems[i].dpAddress, dpItems[i].dpSize , reinterpret_cast<char*>(items[i].pdata));
+                        DeliverRead(dpItems[i], reinterpret_cast<char*>(items[i].pdata), acquired, values);
                     }
                     else {
+                        _lastValueStore.failed(dpItems[i].dpAddress, items[i].Result);
                         Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Error in reading address: ", dpItems[i].dpAddress.c_str());
                     }
                 }
-                addresses << " " << dpItems[i].dpAddress;
             }
-
-            std::stringstream ss;
-            ss << ms._ip << (rorw == Common::S7Utils::Operation::READ ? "Read" : "Write");
-            if( retOpt == 0) {
-                ss << "OK for PLC IP:" << ms._ip << " with " << to_send << " items and PDU size of " << curr_sum + MSG_OH << " for addresses:" << addresses.str() ;
-                Common::Logger::globalInfo(Common::Logger::L3, ss.str().c_str());
+            if(!requestValues.empty()) {
+                QueueValues(requestValues);
             }
-            else {
+            Common::Trace::record("scatter", scatterStart, std::chrono::steady_clock::now(), to_send);
+
+            if(retOpt != 0) {
                 ++ioFailures;
-                ss << "KO for PLC IP:" << ms._ip << " with " << to_send << " items and PDU size of " << curr_sum + MSG_OH << " for addresses:" << addresses.str() ;
-                ss << " ioFailures: " << ioFailures;
-                Common::Logger::globalWarning(ss.str().c_str());
+            }
+            // The summary lists every address of the request: only build it when it is written
+            if(retOpt != 0 || Common::Logger::isEnabled(Common::Logger::L3)) {
+                std::stringstream addresses;
+                for(uint i = last_index; i < last_index + to_send; i++) {
+                    addresses << " " << dpItems[i].dpAddress;
+                }
+
+                std::stringstream ss;
+                ss << ms._ip << (rorw == Common::S7Utils::Operation::READ ? "Read" : "Write");
+                if( retOpt == 0) {
+                    ss << "OK for PLC IP:" << ms._ip << " with " << to_send << " items and PDU size of " << curr_sum + MSG_OH << " for addresses:" << addresses.str() ;
+                    Common::Logger::globalInfo(Common::Logger::L3, ss.str().c_str());
+                }
+                else {
+                    ss << "KO for PLC IP:" << ms._ip << " with " << to_send << " items and PDU size of " << curr_sum + MSG_OH << " for addresses:" << addresses.str() ;
+                    ss << " ioFailures: " << ioFailures;
+                    Common::Logger::globalWarning(ss.str().c_str());
+                }
             }
             last_index += to_send;
         }
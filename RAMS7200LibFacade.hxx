@@ -21,6 +21,7 @@
 #define OVERHEAD_WRITE_VARIABLE 16
 #define PDU_SIZE 240
 
+#include <atomic>
 #include <string>
 #include <chrono>
 #include <vector>
@@ -36,12 +37,16 @@
 #include <condition_variable>
 #include <mutex>
 #include <thread>
+#include <random>
 
+#include "RAMS7200DeliveryQueue.hxx"
+#include "RAMS7200LastValues.hxx"
 #include "RAMS7200MS.hxx"
 #include "Common/Logger.hxx"
 
 
 using queueToDPCallback = std::function<void(const std::string& dp_address, uint16_t length, char* payload)>;
+using queueBatchToDPCallback = std::function<void(toDPBatch& batch)>;
 
 /**
  * @brief The RAMS7200LibFacade class is a facade and encompasses all the consumer interaction with snap7
@@ -54,8 +59,9 @@ public:
      * @brief RAMS7200LibFacade constructor
      * @param RAMS7200MS & : const reference to the MS object
      * @param queueToDPCallback : a callback that will be called after each poll
+     * @param queueBatchToDPCallback : queues the values of a full refresh at once, optional
      * */
-    RAMS7200LibFacade(RAMS7200MS& , queueToDPCallback);
+    RAMS7200LibFacade(RAMS7200MS& , queueToDPCallback, queueBatchToDPCallback = nullptr);
     
 
     RAMS7200LibFacade(const RAMS7200LibFacade&) = delete;
@@ -64,12 +70,31 @@ public:
     RAMS7200LibFacade& operator=(RAMS7200LibFacade&&) = delete;
     ~RAMS7200LibFacade() = default;
 
-    void Poll();
+    /**
+     * @brief Acquisition loop of a PLC thread: connects, then writes and polls every cycle until
+     * driverRun or the run flag of the MS is cleared
+     */
+    void Run(const std::atomic<bool>& driverRun);
+
+    /**
+     * @param all : polls every variable, whatever its poll time
+     */
+    void Poll(bool all = false);
+    /**
+     * @brief Polls every variable in as few requests as the PDU allows, and queues the values that
+     * differ from the last delivered ones as one batch. Done after each (re)connection and switchover.
+     */
+    void Refresh();
     void WriteToPLC();
     void EnsureConnection(bool reduSwitch);
 
     void Connect();
 
+    /**
+     * @brief Accounts one poll cycle and publishes the PLC statistics when due
+     */
+    void UpdateStats(std::chrono::steady_clock::duration cycleDuration, bool overrun);
+
     template <typename T>
     void sleep_for(T duration)
     {
@@ -85,11 +110,41 @@ private:
         // DP info
         const std::string dpAddress;
         const int dpSize;
+        // Writes: when writeData queued the value, Reads: start of the poll
+        const std::chrono::steady_clock::time_point requested;
+        // Reads: deliver every value read, aggregate it and filter it
+        const bool raw;
+        const std::vector<RAMS7200Aggregation> aggregations;
+        const std::vector<RAMS7200Deadband> deadbands;
     };
     
     void Reconnect();
     void Disconnect();
+    /**
+     * @brief Warm standby: reads one byte so that the connection of a passive driver stays open
+     * @return false if the read failed: the connection is renewed by the next EnsureConnection
+     */
+    bool KeepAlive();
+    /**
+     * @brief Warm standby: sleeps until the given time or until the driver becomes active
+     */
+    void WaitWhilePassive(std::chrono::steady_clock::time_point until);
     void RAMS7200MarkDeviceConnectionError(bool);
+    /**
+     * @brief Adds a good value read to the values to queue, unless a full refresh finds it unchanged,
+     * the aggregates of the windows it closes and the filtered values it passes
+     */
+    void DeliverRead(const dpItem& item, char* payload, std::chrono::system_clock::time_point acquired, toDPBatch& values);
+    void QueueValues(toDPBatch& values);
+    /**
+     * @brief Opens the last value file of the PLC and loads it as the last delivered values
+     */
+    void RestoreLastValues();
+    /**
+     * @brief Drops the last values of the addresses removed from the PLC, in memory and in the file, and
+     * forgets the values that did not reach their DPE (delivery queue overflow, toDp failure)
+     */
+    void ForgetAddresses();
     void RAMS7200ReadWriteMaxN(std::vector<dpItem> dpItems, std::vector<TS7DataItem> items, const uint N, const int PDU_SZ, const int VAR_OH, const int MSG_OH, const Common::S7Utils::Operation rorw);
 
     int ioFailures{0};
@@ -97,7 +152,20 @@ private:
 
     // S7 related
     queueToDPCallback _queueToDPCB;
+    queueBatchToDPCallback _queueBatchToDPCB;
     bool _wasConnected{false};
+    bool _refreshPending{false};
+    // Last delivered value per DP address, only used by the PLC thread, and its copy kept across restarts
+    std::unordered_map<std::string, std::string> _lastValues;
+    RAMS7200LastValues _lastValueStore;
+    // Set during Refresh(): the values read go into this batch instead of one batch per request
+    toDPBatch* _refreshBatch{nullptr};
+    size_t _refreshUnchanged{0};
+    // Current window per aggregated DP address
+    std::unordered_map<std::string, RAMS7200Aggregator> _aggregators;
+    // Sign of the last delivered change per filtered DP address, for the hysteresis
+    std::unordered_map<std::string, int> _deadbandDirections;
+    std::minstd_rand _random{std::random_device{}()}; // reconnection jitter
     std::unique_ptr<TS7Client> _client{nullptr};
 };
 
@@ -9,31 +9,110 @@ RAMS7200MS::RAMS7200MS(std::string dp_address) :
  _tp_ip(_ip_combo == _ip ? "" : _ip_combo.substr(_ip_combo.find(";") + 1, _ip_combo.size() - 1))
 {}
 
-void RAMS7200MS::addVar(std::string varName, int pollTime)
+// Adds the option to the list unless it is there
+template <typename T>
+static void addOption(std::vector<T>& options, T& option, int wordLen)
+{
+    option.wordLen = wordLen;
+    auto same = [&](const T& o) {return o.field == option.field;};
+    if(std::none_of(options.begin(), options.end(), same)) {
+        options.push_back(option);
+    }
+}
+
+template <typename T>
+static void removeOption(std::vector<T>& options, const std::string& field)
+{
+    auto same = [&](const T& o) {return o.field == field;};
+    options.erase(std::remove_if(options.begin(), options.end(), same), options.end());
+}
+
+RAMS7200MSVar* RAMS7200MS::addVar(std::string varName, int pollTime, const std::string& option)
 {
     std::lock_guard<std::mutex> lock{_rwmutex};
     auto var = RAMS7200MSVar(varName, pollTime, Common::S7Utils::TS7DataItemFromAddress(varName, false));
-    vars.emplace(varName, std::move(var));
+    auto& msVar = vars.emplace(varName, std::move(var)).first->second;
+    RAMS7200Aggregation aggregation;
+    RAMS7200Deadband deadband;
+    if(option.empty()) {
+        msVar._raw = true;
+    } else if(RAMS7200Aggregation::parse(option, aggregation) && aggregation.supports(msVar._toDP.WordLen)) {
+        addOption(msVar._aggregations, aggregation, msVar._toDP.WordLen);
+    } else if(RAMS7200Deadband::parse(option, deadband)) {
+        addOption(msVar._deadbands, deadband, msVar._toDP.WordLen);
+    }
+    return &msVar;
 }
 
-void RAMS7200MS::removeVar(std::string varName)
+void RAMS7200MS::removeVar(std::string varName, const std::string& option)
 {
     std::lock_guard<std::mutex> lock{_rwmutex};
     auto it = vars.find(varName);
     if(it != vars.end()) {
-        vars.erase(it);
+        auto& msVar = it->second;
+        const std::string address = _ip_combo + "$" + varName + "$" + std::to_string(msVar.pollTime);
+        _removedAddresses.push_back(option.empty() ? address : address + "$" + option);
+        if(option.empty()) {
+            msVar._raw = false;
+        } else {
+            removeOption(msVar._aggregations, option);
+            removeOption(msVar._deadbands, option);
+        }
+        if(!msVar._raw && msVar._aggregations.empty() && msVar._deadbands.empty()) {
+            vars.erase(it);
+        }
     }
 }
 
+RAMS7200MSVar* RAMS7200MS::findVar(const std::string& varName)
+{
+    std::lock_guard<std::mutex> lock{_rwmutex};
+    auto it = vars.find(varName);
+    return it != vars.end() ? &(it->second) : nullptr;
+}
+
+void RAMS7200MS::addBurstVar(const std::string& varName)
+{
+    std::lock_guard<std::mutex> lock{_rwmutex};
+    _burstVars.insert(varName);
+}
+
+void RAMS7200MS::removeBurstVar(const std::string& varName)
+{
+    std::lock_guard<std::mutex> lock{_rwmutex};
+    _burstVars.erase(varName);
+}
+
+std::vector<std::string> RAMS7200MS::burstVars()
+{
+    std::lock_guard<std::mutex> lock{_rwmutex};
+    return std::vector<std::string>(_burstVars.begin(), _burstVars.end());
+}
+
+void RAMS7200MS::valueUndelivered(const std::string& address)
+{
+    std::lock_guard<std::mutex> lock{_rwmutex};
+    _undeliveredAddresses.push_back(address);
+}
+
 void RAMS7200MS::queuePLCItem(const std::string& varName, void* item)
 {
     try
     {
         std::lock_guard<std::mutex> lock{_rwmutex};
-        vars.at(varName)._toPlc.pdata = item;
+        auto& var = vars.at(varName);
+        var._toPlc.pdata = item;
+        var._toPlcQueued = std::chrono::steady_clock::now();
     }
     catch(const std::out_of_range& e)
     {
         Common::Logger::globalWarning(__PRETTY_FUNCTION__, "Undefined address", e.what());
     }
 }
+
+void RAMS7200MS::queuePLCItem(RAMS7200MSVar& var, void* item)
+{
+    std::lock_guard<std::mutex> lock{_rwmutex};
+    var._toPlc.pdata = item;
+    var._toPlcQueued = std::chrono::steady_clock::now();
+}
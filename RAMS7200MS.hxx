@@ -17,11 +17,15 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include <set>
 #include <chrono>
 #include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include "Common/S7Utils.hxx"
+#include "RAMS7200Stats.hxx"
+#include "RAMS7200Aggregate.hxx"
+#include "RAMS7200Deadband.hxx"
 
 using MSQitem = std::pair<std::string, void*>;
 
@@ -33,9 +37,14 @@ struct RAMS7200MSVar
     const uint32_t pollTime;
     std::chrono::steady_clock::time_point lastPollTime{std::chrono::steady_clock::now()};
     TS7DataItem _toPlc;
+    std::chrono::steady_clock::time_point _toPlcQueued; // writeData time of the pending _toPlc value
     TS7DataItem _toDP;
     bool _isString{false};
-    
+    // Addresses of the variable: one delivering every value read, the aggregated ones and the filtered ones
+    bool _raw{false};
+    std::vector<RAMS7200Aggregation> _aggregations;
+    std::vector<RAMS7200Deadband> _deadbands;
+
 };
 
 
@@ -49,29 +58,52 @@ class RAMS7200MS
         RAMS7200MS(RAMS7200MS&& other) noexcept : _ip_combo(other._ip_combo), _ip(other._ip), _tp_ip(other._tp_ip) {
             if(this == &other) return;
             vars = std::move(other.vars);
+            _burstVars = std::move(other._burstVars);
             _run = other._run.load();
         }
         RAMS7200MS& operator=(RAMS7200MS&& other) = delete;
         ~RAMS7200MS() = default;
     protected:    
-        void addVar(std::string varName, int pollTime); // TODO : poll time can be updated on the fly? AL: yes
-        void removeVar(std::string varName);
+        // option: last field of an aggregated or filtered address, e.g. mean60 or db0.5, empty for the address of every value
+        RAMS7200MSVar* addVar(std::string varName, int pollTime, const std::string& option = ""); // TODO : poll time can be updated on the fly? AL: yes
+        // The variable goes with its last address. The PLC thread forgets the last value of the address.
+        void removeVar(std::string varName, const std::string& option = "");
+        RAMS7200MSVar* findVar(const std::string& varName);
+        // Addresses sampled by a burst, they are not polled
+        void addBurstVar(const std::string& varName);
+        void removeBurstVar(const std::string& varName);
+        std::vector<std::string> burstVars();
         const std::string _ip_combo; 
         const std::string _ip;
         const std::string _tp_ip;
 
+        // A value of the address did not make it to its DPE: the PLC thread forgets it as last delivered value
+        void valueUndelivered(const std::string& address);
         void queuePLCItem(const std::string& varName, void* item);
-        inline bool isEmpty() const {return vars.empty();}
+        void queuePLCItem(RAMS7200MSVar& var, void* item);
+        inline bool isEmpty() const {return vars.empty() && _burstVars.empty();}
     private: 
         std::unordered_map<std::string, RAMS7200MSVar> vars;
+        std::set<std::string> _burstVars;
+        std::vector<std::string> _removedAddresses; // DP addresses removed since the PLC thread last forgot them
+        std::vector<std::string> _undeliveredAddresses; // DP addresses of values dropped before their DPE, "": all
         std::atomic<bool> _run{false};
         std::mutex _rwmutex;
         bool previouslyConnected{false};
         std::mutex _threadMutex;
         std::condition_variable _threadCv;
+        RAMS7200Stats _stats;
+
+        // Startup KPI: result of the first connection attempt, set by the PLC thread
+        enum class FirstConnect {PENDING, CONNECTED, FAILED};
+        std::atomic<FirstConnect> _firstConnect{FirstConnect::PENDING};
+        bool _firstValueDelivered{false}; // workProc only
 
     friend class RAMS7200LibFacade;
     friend class RAMS7200Panel;
+    friend class RAMS7200PanelLoop;
     friend class RAMS7200HWService;
     friend class RAMS7200HWMapper;
+    friend class RAMS7200LoadGenerator;
+    friend class RAMS7200LoggingBench;
 };
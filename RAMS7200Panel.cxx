@@ -1,615 +1,561 @@
 #include "RAMS7200Panel.hxx"
 #include "Common/Logger.hxx"
-#include "RAMS7200Resources.hxx"
+#include "RAMS7200Adapter.hxx"
 #include "Common/Constants.hxx"
-#include "RAMS7200Encryption.hxx"
 #include <arpa/inet.h>
-#include <sys/socket.h>
 #include <fcntl.h>
-#include <poll.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+static const char ack_drv[] = "##DRV_ACK##\n\n";
+static const char ack_pnl[] = "##PNL_ACK##";
+
+static const auto CONNECT_TIMEOUT = std::chrono::seconds(10);
+static const auto RECEIVE_TIMEOUT = std::chrono::seconds(120);
 
-RAMS7200Panel::RAMS7200Panel(RAMS7200MS& ms, queueToDPCallback cb)
-    : ms(ms), _queueToDPCB(cb)
+RAMS7200Panel::RAMS7200Panel(RAMS7200MS& ms, queueToDPCallback cb, int epollFd, int port, RAMS7200UserFile& userFile, std::vector<char>& rxBuffer)
+    : ms(ms), _queueToDPCB(cb), _epollFd(epollFd), _port(port), _userFile(userFile), _rxBuffer(rxBuffer)
 {
      Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Initialized RAMS7200Panel with TP IP: " + CharString(ms._tp_ip.c_str()));
 }
 
+RAMS7200Panel::~RAMS7200Panel()
+{
+    closeSocket();
+}
+
 void RAMS7200Panel::writeTouchConnErrDPE(bool val) {
+    if(_connErrPublished && touch_panel_conn_error == val) {
+        return;
+    }
     touch_panel_conn_error = val;
-    
+    _connErrPublished = true;
+
     Common::Logger::globalInfo(Common::Logger::L1,"FSThread: Touch panel connection erorr status for Panel IP : ", ms._tp_ip.c_str(), std::to_string(touch_panel_conn_error).c_str());
     auto pdata = new char[sizeof(bool)];
     memcpy(pdata, &touch_panel_conn_error , sizeof(bool));
     this->_queueToDPCB(ms._ip_combo + "$_touchConError", sizeof(bool), reinterpret_cast<char*>(pdata));
 }
 
-void RAMS7200Panel::FileSharingTask(int port) { // TODO: review this in depth
-    
-    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Start of FS thread, Requested Touch Panel IP is", ms._tp_ip.c_str());
+bool RAMS7200Panel::tick(std::chrono::steady_clock::time_point now) {
+    if(!ms._run) {
+        closeSocket();
+        return false;
+    }
+
+    if(RAMS7200Adapter::getDisableCommands()) {
+        // The Server is Passive (for redundant systems): only drop the connection between treatments
+        if(_state == State::BACKOFF || _state == State::CONNECTING || _state == State::HANDSHAKE) {
+            closeSocket();
+            _state = State::PASSIVE;
+        }
+        if(_state == State::PASSIVE) {
+            _deadline = now + std::chrono::seconds(1);
+        }
+    } else if(_state == State::PASSIVE) {
+        _state = State::BACKOFF;
+        _deadline = now;
+    }
+
+    if(_state != State::PASSIVE && now >= _deadline) {
+        onTimeout();
+    }
+    return true;
+}
+
+void RAMS7200Panel::onTimeout() {
+    const char *ip = ms._tp_ip.c_str();
+    switch(_state) {
+        case State::PASSIVE:
+            break;
+        case State::BACKOFF:
+            connect();
+            break;
+        case State::CONNECTING:
+            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Could not connect in 10 seconds to IP\n", ip);
+            closeSocket();
+            scheduleReconnect();
+            break;
+        default:
+            disconnect("FSThread: Waited 2 minutes without receiving data so disconnecting from TP IP");
+            break;
+    }
+}
 
-    int iRetSend, iRetRecv;
-    FILE *fpUser;
-    int count;
+void RAMS7200Panel::connect() {
     const char *ip = ms._tp_ip.c_str();
 
-    int socket_desc = -1;
-    bool switch_to_event;
+    writeTouchConnErrDPE(true);
+
+    LOGGER_INFO(Common::Logger::L2, "FSThread: Connecting to touch panel ip:port", ip, std::to_string(_port).c_str());
 
-    char ack_drv[] = "##DRV_ACK##\n\n";
-    char ack_pnl[] = "##PNL_ACK##";
+    _fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(_fd == -1) {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "FSThread: Error establishing socket for TP IP: ", ip);
+        scheduleReconnect();
+        return;
+    }
 
-    bool sock_err = false;
     struct sockaddr_in server_addr;
-    
-    //memset(&server_addr, 0, sizeof(server_addr));
+    memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
-    server_addr.sin_port = htons(port); //host to network short
-    //inet_aton(ip, &server_addr.sin_addr); //from dots and numbers to in_addr
-    server_addr.sin_addr.s_addr = inet_addr(ms._tp_ip.c_str());
-
-    //Set timeout for 2 minutes on receive operations
-    struct timeval tv;                                                              
+    server_addr.sin_port = htons(_port); //host to network short
+    server_addr.sin_addr.s_addr = inet_addr(ip);
+
+    if(::connect(_fd, (struct sockaddr *) &server_addr, sizeof(server_addr)) == 0) {
+        onConnected();
+        return;
+    }
+
+    if(errno != EINPROGRESS) {
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread : Non blocking connect failed for TP IP: ", ip);
+        closeSocket();
+        scheduleReconnect();
+        return;
+    }
+
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread : Waiting upto 10 seconds to connect to IP", ip);
+    _state = State::CONNECTING;
+    _deadline = std::chrono::steady_clock::now() + CONNECT_TIMEOUT;
+    updateInterest();
+}
 
-    tv.tv_sec = 120;
-    tv.tv_usec = 0;  
+void RAMS7200Panel::onConnectCompleted() {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if(getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &len) < 0 || error != 0) {
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Error in nonblocking connect call for IP\n", ms._tp_ip.c_str());
+        closeSocket();
+        scheduleReconnect();
+        return;
+    }
+    onConnected();
+}
 
-    int connect_try_count;
+void RAMS7200Panel::onConnected() {
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "FSThread: Connected to Touch Panel on IP: ", ms._tp_ip.c_str());
+    _connectTryCount = 0;
+    writeTouchConnErrDPE(false);
+    expectHandshake();
+}
 
-    connect_try_count = 0;
-    
-    //Always ready and trying to connect	
-    while(ms._run) {
-        while(RAMS7200Resources::getDisableCommands()){
-            // If the Server is Passive (for redundant systems)
-           sleep_for(std::chrono::seconds(1));
-        };
+void RAMS7200Panel::scheduleReconnect() {
+    const char *ip = ms._tp_ip.c_str();
+    _connectTryCount++;
+    _state = State::BACKOFF;
+
+    if(_connectTryCount > 3) {
+        //Tried three times consecutively.
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Trying Again in 10 seconds to connect to TP IP: ",ip);
+        _deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    } else {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "FSThread: Trying Again in 4 seconds to connect to TP IP: ", ip);
+        _deadline = std::chrono::steady_clock::now() + std::chrono::seconds(4);
+    }
+}
 
-        writeTouchConnErrDPE(true);
+void RAMS7200Panel::disconnect(const char* reason) {
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, reason, ms._tp_ip.c_str());
+    closeSocket();
+    writeTouchConnErrDPE(true);
+    // Panel was reachable: reconnect straight away
+    _state = State::BACKOFF;
+    _deadline = std::chrono::steady_clock::now();
+}
 
+void RAMS7200Panel::closeSocket() {
+    discardFile();
+    _out.clear();
+    if(_fd != -1) {
+        epoll_ctl(_epollFd, EPOLL_CTL_DEL, _fd, nullptr);
+        close(_fd);
+        _fd = -1;
+        _interest = 0;
+    }
+}
 
-        Common::Logger::globalInfo(Common::Logger::L2, "FSThread: Connecting to touch panel ip:port", ms._tp_ip.c_str(), std::to_string(port).c_str());
+void RAMS7200Panel::expectHandshake() {
+    Common::Logger::globalInfo(Common::Logger::L2, __PRETTY_FUNCTION__, "FSThread: Waiting upto 2 minutes to receive number for handshake for TP IP", ms._tp_ip.c_str());
+    expect(State::HANDSHAKE);
+}
 
-        socket_desc = socket(AF_INET, SOCK_STREAM, 0);
+void RAMS7200Panel::expect(State state) {
+    _state = state;
+    _deadline = std::chrono::steady_clock::now() + RECEIVE_TIMEOUT;
+    updateInterest();
+}
 
-         if(socket_desc == -1) {
-            Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "FSThread: Error establishing socket for TP IP: ", ip);
-            //TODO: Raise Alarm
-            return;
-        }
-    
-        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "FSThread: Socket created to try to connect to IP: \n", ip);	
-
-        //Setting socket non blocking for the connect call.
-        int socket_desc_flagbf;
-        
-        bool nonblock;
-        int rc;
-
-        nonblock = false;
-        bool try_again, timed_out;
-
-        try_again = false;
-        timed_out = false;
-        rc = 0;
-
-        if( (socket_desc_flagbf = fcntl(socket_desc, F_GETFL, 0) >= 0 )) {
-            
-            if(fcntl(socket_desc, F_SETFL, socket_desc_flagbf | O_NONBLOCK) >= 0) {
-
-                nonblock = true;
-
-                // Start connecting (asynchronously)
-                do {
-                    if ( connect(socket_desc, (struct sockaddr *) &server_addr, sizeof(server_addr)) < 0 ) {
-                        // Did connect return an error? If so, we'll try again after some time.
-                        if ((errno != EWOULDBLOCK) && (errno != EINPROGRESS)) {
-                            try_again = true;
-                            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread : Non blocking connect failed for TP IP: ", ip);
-                        }
-                        // Otherwise, we'll wait for it to complete.
-                        else {
-                            // Set a deadline timestamp 'timeout' ms from now (needed b/c poll can be interrupted)
-                            struct timespec now;
-                            if( clock_gettime(CLOCK_MONOTONIC, &now) < 0 ) { 
-                                try_again = true; 
-                                break; 
-                            }
-                            struct timespec deadline = { .tv_sec = now.tv_sec + 10, .tv_nsec = now.tv_nsec }; //Set 10 second timeout
-                            // Wait for the connection to complete.
-                            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread : Waiting upto 10 seconds to connect to IP", ip);
-                            do {
-                                // Calculate how long until the deadline
-                                if(clock_gettime(CLOCK_MONOTONIC, &now)<0) { 
-                                    try_again = true; 
-                                    break; 
-                                }
-
-                                int ms_until_deadline = (int)(  (deadline.tv_sec  - now.tv_sec)*1000l
-                                                            + (deadline.tv_nsec - now.tv_nsec)/1000000l);
-                                if(ms_until_deadline < 0) { 
-                                    rc=0; 
-                                    timed_out = true;
-                                    try_again = true;
-                                    break;
-                                }
-                                // Wait for connect to complete (or for the timeout deadline)
-                                struct pollfd pfds[] = { { .fd = socket_desc, .events = POLLOUT } }; //Waiting for writing access on the socket descriptor
-                                
-                                rc = poll(pfds, 1, ms_until_deadline);
-                                // If poll 'succeeded', make sure it *really* succeeded
-                                if(rc > 0) {
-                                    int error = 0; 
-                                    
-                                    socklen_t len = sizeof(error);
-                                    
-                                    int retval = getsockopt(socket_desc, SOL_SOCKET, SO_ERROR, &error, &len);
-                                    
-                                    if( retval == 0 ) 
-                                        errno = error;
-                                    
-                                    if( error != 0) 
-                                        rc = -1;
-                                }
-                            } while ( rc == -1 && errno == EINTR && ms._run.load());
-                            // Did poll timeout? If so, fail.
-                            if(rc==0) {
-                                timed_out = true;
-                                try_again = true;
-                            }
-
-                            if(rc == -1 && !timed_out) {
-                                try_again = true;
-                            }
-                        }
-                    }
-                } while(0);
-            }
-        }
+void RAMS7200Panel::updateInterest() {
+    if(_fd == -1) {
+        return;
+    }
+    uint32_t interest = 0;
+    if(_state == State::CONNECTING || _state == State::USER_SYNC || !_out.empty()) {
+        interest |= EPOLLOUT;
+    }
+    if(_state != State::CONNECTING && _state != State::USER_SYNC) {
+        interest |= EPOLLIN;
+    }
+    if(interest == _interest) {
+        return;
+    }
+
+    struct epoll_event ev;
+    ev.events = interest;
+    ev.data.ptr = this;
+    epoll_ctl(_epollFd, _interest ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, _fd, &ev);
+    _interest = interest;
+}
 
-        if(nonblock and try_again) {
-            //Close connection and connect again after some time
-
-            if(timed_out)
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Could not connect in 10 seconds to IP\n", ip);
-            else
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Error in nonblocking connect call or in getting current time for IP\n", ip);
-            connect_try_count++;
-            close(socket_desc);
-
-            if(connect_try_count > 3) {
-                //Tried three times consecutively. 
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Trying Again in 10 seconds to connect to TP IP: ",ip);
-                //Raise alarm with higher severity. Sleep for 10 seconds.
-                sleep_for(std::chrono::seconds(10));
-            } else {
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "FSThread: Trying Again in 4 seconds to connect to TP IP: ", ip);
-                //TODO: Raise Alarm
-                sleep_for(std::chrono::seconds(4));
-            }
+void RAMS7200Panel::onEvents(uint32_t events) {
+    if(_fd == -1) {
+        return;
+    }
 
-            continue;
-        }
+    if(_state == State::CONNECTING) {
+        onConnectCompleted();
+        return;
+    }
 
-        if( !nonblock ) {
-            //Could not set the socket as non blocking. Continue with blocking connect
-            if( connect(socket_desc, (struct sockaddr *) &server_addr, sizeof(server_addr)) < 0 ) {
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "FSThread: Error in connecting (blocking) to Touch Panel for IP: \n", ip);
-                connect_try_count++;
-                close(socket_desc);
-
-                if(connect_try_count > 3) {
-                    //Tried three times consecutively. 
-                    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Trying Again in 10 seconds to TP IP: ", ip);
-                    //Raise alarm with higher severity. Sleep for 10 seconds.
-                    sleep_for( std::chrono::seconds(10));
-                } else {
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Trying Again in 4 seconds to TP IP: ", ip);
-                    //TODO: Raise Alarm
-                    sleep_for( std::chrono::seconds(4));
-                }
-                
-                continue;
-            }
+    if(events & EPOLLOUT) {
+        if(!flush()) {
+            disconnect("FSThread: Error in sending data so disconnecting from TP IP");
+            return;
         }
-
-        // Restore original O_NONBLOCK state
-        if( nonblock && ( fcntl(socket_desc ,F_SETFL,socket_desc_flagbf) < 0 ) ) {
-            //Close connection and connect again after some time
-             Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error in making socket blocking again for TP IP", ip);
-            connect_try_count++;
-            close(socket_desc);
-
-            if(connect_try_count > 3) {
-                //Tried three times consecutively. 
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Trying Again in 10 seconds for TP IP", ip);
-                //Raise alarm with higher severity. Sleep for 10 seconds.
-                sleep_for( std::chrono::seconds(10));
-            } else {
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Trying Again in 4 seconds for TP IP", ip);
-                //TODO: Raise Alarm
-                sleep_for( std::chrono::seconds(4));
-            }
-            
-            continue;
+        if(_state == State::USER_SYNC && _out.empty()) {
+            finishUserSync();
         }
+    }
 
-        // Success
-        
-        setsockopt(socket_desc, SOL_SOCKET, SO_RCVTIMEO, (const char *)&tv, sizeof tv);
-        
-        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "FSThread: Connected to Touch Panel on IP: ", ip);
-
-        connect_try_count = 0;
-
-        while(ms._run) { //Connected to client - keep waiting for either User message or Logfile message
-            int bufsize = 1024;
-            char buffer[bufsize], subbuffer[12], lastMsg[bufsize];
-
-            writeTouchConnErrDPE(false);
-
+    if(_fd != -1 && (events & EPOLLIN)) {
+        onReadable();
+    } else if(_fd != -1 && (events & (EPOLLERR | EPOLLHUP))) {
+        disconnect("FSThread: Error in socket connection so disconnecting from TP IP");
+    }
 
-            if(RAMS7200Resources::getDisableCommands()) {
-                //Driver in passive mode. (for redundant systems)
-                close(socket_desc);
-                break;
-            }
+    updateInterest();
+}
 
-            Common::Logger::globalInfo(Common::Logger::L2, __PRETTY_FUNCTION__, "FSThread: Waiting upto 2 minutes to receive number for handshake for TP IP", ip);
-            memset(buffer, 0, sizeof(buffer));
+ssize_t RAMS7200Panel::receive(char* buffer, size_t len) {
+    ssize_t iRetRecv = recv(_fd, buffer, len, 0);
+    if(iRetRecv < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return -EAGAIN;
+    }
+    if(iRetRecv <= 0) {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Return code of recv was " + CharString(std::to_string(iRetRecv).c_str()) + " from TP IP: ", ms._tp_ip.c_str());
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error number is" + CharString(std::to_string(errno).c_str())+" for TP IP: ", ms._tp_ip.c_str());
+        return 0;
+    }
+    return iRetRecv;
+}
 
-            if( recv(socket_desc, buffer, bufsize, 0) <= 0 ) {
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "FSThread: Error in receiving number for handshake from Touch Panel so disconnecting from TP IP", ip);
-                close(socket_desc);
-                break;
+void RAMS7200Panel::onReadable() {
+    const char *ip = ms._tp_ip.c_str();
+    if(_state == State::LOGFILE_DATA) {
+        // File content bypasses the small message buffer: large reads, no clearing, no termination char
+        ssize_t iRetRecv = receive(_rxBuffer.data(), _rxBuffer.size());
+        if(iRetRecv == -EAGAIN) {
+            return;
+        }
+        bool complete = false;
+        if(iRetRecv == 0) {
+            disconnect("Error in socket connection with TP IP: ");
+        } else if(!handleFileData(_rxBuffer.data(), iRetRecv, complete)) {
+            disconnect("Error in writing received file content so disconnecting from TP IP: ");
+        } else if(!complete) {
+            expect(State::LOGFILE_DATA);
+        } else if(!finishFileReception()) {
+            disconnect("Error in publishing received file so disconnecting from TP IP: ");
+        }
+        return;
+    }
+
+    ssize_t iRetRecv = receive(_buffer, bufsize - 1); //Keep space for 1 termination char on messages
+    if(iRetRecv == -EAGAIN) {
+        return;
+    }
+    _buffer[iRetRecv] = '\0';
+
+    switch(_state) {
+        case State::HANDSHAKE:
+        {
+            if(iRetRecv == 0) {
+                disconnect("FSThread: Error in receiving number for handshake from Touch Panel so disconnecting from TP IP");
+                return;
             }
-        
-            int rand_rcv = atoi(buffer);
-            Common::Logger::globalInfo(Common::Logger::L2, __PRETTY_FUNCTION__,"FSThread: Received number from client", std::to_string(rand_rcv).c_str());
-
-            sprintf(buffer, "%d",rand_rcv+1);
-        
-            Common::Logger::globalInfo(Common::Logger::L2, __PRETTY_FUNCTION__,"FSThread: Sending received number + 1 to client for handshake", buffer);
-            
-            if( send(socket_desc, buffer, strlen(buffer), 0) < 0 ) {
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Sending of rand + 1 for connection initiation failed hence Closing connection for TP IP", ip);
-                close(socket_desc);
-                break;
+            int rand_rcv = atoi(_buffer);
+            LOGGER_INFO(Common::Logger::L2, __PRETTY_FUNCTION__,"FSThread: Received number from client", std::to_string(rand_rcv).c_str());
+
+            sprintf(_buffer, "%d",rand_rcv+1);
+            Common::Logger::globalInfo(Common::Logger::L2, __PRETTY_FUNCTION__,"FSThread: Sending received number + 1 to client for handshake", _buffer);
+            if(!queueSend(_buffer, strlen(_buffer))) {
+                disconnect("Sending of rand + 1 for connection initiation failed hence Closing connection for TP IP");
+                return;
             }
-
-            Common::Logger::globalInfo(Common::Logger::L2, "FSThread: Number Sent");
-
             Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"FSThread: Waiting upto 2 minutes to receive message for treatment for TP IP: ", ip);
-            memset(buffer, 0, sizeof(buffer));
-            //Receive information about treatment 
-            if( recv(socket_desc, buffer, bufsize, 0) <= 0 ) {
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in receiving message for treatment from Touch Panel so disconnecting from TP IP: ", ip);
-                close(socket_desc);
-                break;
+            expect(State::COMMAND);
+            break;
+        }
+        case State::COMMAND:
+            if(iRetRecv == 0) {
+                disconnect("Error in receiving message for treatment from Touch Panel so disconnecting from TP IP: ");
+                return;
             }
-
-            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Received message: " + CharString(buffer) + "from TP IP: ", ip);
-
-            if( strcmp(buffer, "User") == 0 ) {
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Accomodating User File Synchronization Treatment for TP IP:", ip);
-
-                fpUser = fopen( (Common::Constants::getUserFilePath()).c_str(), "r");
-                
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "User File Location is:" + CharString((Common::Constants::getUserFilePath()).c_str()) + "For TP IP: ", ip);
-
-                if(fpUser == NULL) {
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in opening User File to send User data for TP IP : ", ip);
-                    close(socket_desc);
-                    break;
+            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Received message: " + CharString(_buffer) + "from TP IP: ", ip);
+
+            if(strcmp(_buffer, "User") == 0) {
+                startUserSync();
+            } else if(strcmp(_buffer, "LogFile") == 0) {
+                _switchToEvent = false;
+                if(!queueSend(ack_drv, strlen(ack_drv))) {
+                    disconnect("Error in sending marker for LogFile Message to TP IP: ");
+                    return;
                 }
-
-                sock_err = false;
-
-                unsigned char ct[8], key[8] = "123";
-                symmetric_key skey;
-                int err;
-                char pt[9];
-
-                /* schedule the key */
-                if ((err = des_setup(key, /* the key we will use */
-                                    8, /* key is 8 bytes (64-bits) long */
-                                    0, /* 0 == use default # of rounds */
-                                    &skey) /* where to put the scheduled key */
-                                    ) != CRYPT_OK) {
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in setting up the DES keys for TP IP: ",ip);
-                    close(socket_desc);
-                    break;
+                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Sent confirmation marker of LogFile Message to TP IP: ",ip);
+                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Accomodating LogFile Treatment of TP IP: ", ip);
+                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Waiting to receive filename from TP IP: ", ip);
+                expect(State::LOGFILE_NAME);
+            } else {
+                expectHandshake();
+            }
+            break;
+        case State::LOGFILE_NAME:
+            if(iRetRecv == 0) {
+                disconnect("Error in receiving name of file from touchpanel so Disconnecting from TP IP: ");
+                return;
+            }
+            if(strcmp(_buffer, "Event") == 0) { //Start Receiving Event files
+                _switchToEvent = true;
+                if(!queueSend(ack_drv, strlen(ack_drv))) {
+                    disconnect("Error in sending marker for LogFile Message to TP IP:");
+                    return;
                 }
+                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Receiving event files from now from TP IP: ",ip);
+                expect(State::LOGFILE_NAME);
+                return;
+            }
+            if(strlen(_buffer) >= strlen(ack_pnl) && strcmp(&_buffer[strlen(_buffer) - strlen(ack_pnl)], ack_pnl) == 0) {
+                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "LogFile treatment successfully finished for TP IP:", ip);
+                expectHandshake();
+                return;
+            }
+            startFileReception();
+            break;
+        default:
+            break;
+    }
+}
 
-                char temp[10];
-
-                while(fgets(buffer, sizeof(buffer), fpUser)) {
-                    //Common::Logger::globalInfo(Common::Logger::L2, "Line read:\n %s",buffer);
-
-                    for(unsigned int i=0; i<strlen(buffer); i+=8) {
-                        memset(pt, 0, 8);
-                        memset(ct, 0, 8);
-
-                        if(strlen(buffer) - i > 8)
-                            memcpy(pt, &buffer[i], 8); 
-                        else 
-                            memcpy(pt, &buffer[i], strlen(buffer) - i);
-
-                        des_ecb_encrypt(reinterpret_cast<const unsigned char *>(pt), /* encrypt this 8-byte array */ct, /* store encrypted data here */ &skey); /* our previously scheduled key */
-
-                        for(int i = 0; i<8; i ++) {
-                            sprintf(temp, "%d\n", ct[i]);
-
-                            iRetSend = send(socket_desc, temp, strlen(temp), 0);
-                    
-                            if(iRetSend <= 0) {
-                                //Error in sending file content. Abort this Connection
-                                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in sending encrypted data to TP IP: ", ip);
-                                close(socket_desc);
-                                fclose(fpUser);
-                                sock_err = true;
-                                break;
-                            }
-                        }
-                        
-                        if(sock_err) {
-                            break; 
-                        }
-                        
-                    }
-                
-                    if(sock_err) {
-                        break; 
-                    }
-                }
+void RAMS7200Panel::startUserSync() {
+    const char *ip = ms._tp_ip.c_str();
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Accomodating User File Synchronization Treatment for TP IP:", ip);
+
+    std::shared_ptr<const std::string> payload = _userFile.getEncoded(Common::Constants::getUserFilePath());
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "User File Location is:" + CharString((Common::Constants::getUserFilePath()).c_str()) + "For TP IP: ", ip);
+
+    if(!payload) {
+        disconnect("Error in opening or encrypting User File to send User data for TP IP : ");
+        return;
+    }
+
+    // The whole encoded file and the final marker leave in as few writes as the socket allows
+    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Sending User File and final marker ##DRV_ACK## to TP IP", ip);
+    _state = State::USER_SYNC;
+    _deadline = std::chrono::steady_clock::now() + RECEIVE_TIMEOUT;
+    if(!queueSend(payload) || !queueSend(ack_drv, strlen(ack_drv))) {
+        disconnect("Error in sending encrypted data to TP IP: ");
+        return;
+    }
+    if(_out.empty()) {
+        finishUserSync();
+    }
+}
 
-                if(sock_err) {
-                    break; 
-                }
+void RAMS7200Panel::finishUserSync() {
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Succesfully sent User File to TP IP: ", ms._tp_ip.c_str());
+    expectHandshake();
+}
 
-                sprintf(buffer, ack_drv);
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Sending final marker ##DRV_ACK## for User File to TP IP", ip);
-                iRetSend = send(socket_desc, buffer, strlen(buffer), 0);
-                
-                if(iRetSend <= 0) {
-                    //Error in sending file content. Abort this Connection
-                    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error in sending final marker for UserFile to TP IP: ",ip);
-                    close(socket_desc);
-                    fclose(fpUser);
-                    break;
-                }
+void RAMS7200Panel::startFileReception() {
+    const char *ip = ms._tp_ip.c_str();
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,CharString("From TP IP: ") + ip + CharString("Received Full File Name: "), _buffer);
+
+    if(_switchToEvent)
+        _fileName = Common::Constants::getEventFilePath();
+    else
+        _fileName = Common::Constants::getMeasFilePath();
+
+    memcpy(&(_buffer[strlen(_buffer) - 3]), "dat", 3); //Replace .log extension with .dat extension
+    _fileName += _buffer;
+
+    // Readers of the folder only ever see complete files: receive under a hidden name, rename when done
+    const size_t slash = _fileName.rfind('/');
+    const size_t base = slash == std::string::npos ? 0 : slash + 1;
+    _tmpFileName = _fileName.substr(0, base) + "." + _fileName.substr(base) + ".part";
+
+    _fileFd = open(_tmpFileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Received file location: " + CharString(_fileName.c_str()) + " From TP IP: ",ip);
+
+    if(_fileFd == -1) {
+        disconnect("Error in creating new file for file reception from Touch Panel for TP IP");
+        return;
+    }
+
+    if(!queueSend(ack_drv, strlen(ack_drv))) {
+        disconnect("Error in sending marker for File Name reception for TP IP:");
+        return;
+    }
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Sent confirmation marker of file name reception: ##DRV_ACK## to TP IP:",ip);
+
+    _fileEnd.reset();
+    _count = 0;
+    _fileBytes = 0;
+    _fileStart = std::chrono::steady_clock::now();
+    expect(State::LOGFILE_DATA);
+}
 
-                Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Succesfully sent User File to TP IP: ",ip);
-                fclose(fpUser);
-            /////////////////////////////-----------------------------------------------------------////////////////////////
-            } else if( strcmp(buffer, "LogFile") == 0 ) {
+bool RAMS7200Panel::handleFileData(const char* data, size_t len, bool& complete) {
+    _count++;
+    LOGGER_INFO(Common::Logger::L3, "Packet number " + CharString(_count) + " of length " + CharString(static_cast<int>(len)) + " from TP IP: ", ms._tp_ip.c_str());
+
+    // Single pass: a possibly split ##PNL_ACK## is held back by the matcher, the content is
+    // handed over as at most two segments (held back prefix + chunk) written with one call
+    struct iovec iov[2];
+    int count = 0;
+    complete = _fileEnd.feed(data, len, [&](const char* segment, size_t n){
+        iov[count].iov_base = const_cast<char*>(segment);
+        iov[count].iov_len = n;
+        count++;
+    });
+
+    struct iovec* next = iov;
+    while(count > 0) {
+        ssize_t written = writev(_fileFd, next, count);
+        if(written < 0 && errno == EINTR) {
+            continue;
+        }
+        if(written <= 0) {
+            Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error number " + CharString(errno) + " writing file: ", _tmpFileName.c_str());
+            return false;
+        }
+        _fileBytes += written;
+        while(count > 0 && static_cast<size_t>(written) >= next->iov_len) {
+            written -= next->iov_len;
+            ++next;
+            --count;
+        }
+        if(count > 0) {
+            next->iov_base = static_cast<char*>(next->iov_base) + written;
+            next->iov_len -= written;
+        }
+    }
+    return true;
+}
 
-                switch_to_event = false;
+bool RAMS7200Panel::finishFileReception() {
+    const char *ip = ms._tp_ip.c_str();
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"File reading completed for TP IP", ip);
+
+    const uint32_t syncPolicy = Common::Constants::getFileSyncPolicy();
+    if(syncPolicy >= 1 && fsync(_fileFd) != 0) {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error number " + CharString(errno) + " syncing file: ", _tmpFileName.c_str());
+        return false;
+    }
+    const int fd = _fileFd;
+    _fileFd = -1;
+    if(close(fd) != 0 || rename(_tmpFileName.c_str(), _fileName.c_str()) != 0) {
+        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error number " + CharString(errno) + " publishing file: ", _fileName.c_str());
+        unlink(_tmpFileName.c_str());
+        return false;
+    }
+    if(syncPolicy >= 2) {
+        // Makes the rename itself durable
+        const size_t slash = _fileName.rfind('/');
+        const int dirFd = open(slash == std::string::npos ? "." : _fileName.substr(0, slash + 1).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if(dirFd != -1) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - _fileStart).count();
+    const double kBps = elapsed > 0 ? (_fileBytes / 1024.0) / (elapsed / 1e6) : 0.0;
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,
+        "Received " + CharString(static_cast<int>(_fileBytes)) + " bytes in " + CharString(_count) + " reads, " + CharString(static_cast<int>(elapsed / 1000)) + " ms, " + CharString(static_cast<int>(kBps)) + " kB/s: ",
+        _fileName.c_str());
+
+    if(!queueSend(ack_drv, strlen(ack_drv))) {
+        disconnect("Error in sending final marker for Log File to TP IP:");
+        return true;
+    }
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Sent confirmation marker of file receipt: ##DRV_ACK## to TP IP: ", ip);
+    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Waiting to receive filename from TP IP: ", ip);
+    expect(State::LOGFILE_NAME);
+    return true;
+}
 
-                sprintf(buffer, ack_drv);
-                    
-                iRetSend = send(socket_desc, buffer, strlen(buffer), 0); 		
+void RAMS7200Panel::discardFile() {
+    if(_fileFd == -1) {
+        return;
+    }
+    // Interrupted transfer: never publish a partial file
+    close(_fileFd);
+    _fileFd = -1;
+    unlink(_tmpFileName.c_str());
+}
 
-                if(iRetSend <= 0) {
-                    //Error in sending final marker for Log File. Abort this Connection
-                    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error in sending marker for LogFile Message to TP IP: ", ip);
-                    close(socket_desc);
-                    sock_err = true;
-                    break;
-                }
-                    
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Sent confirmation marker of LogFile Message to TP IP: ",ip);
+bool RAMS7200Panel::queueSend(const char* data, size_t len) {
+    return queueSend(std::make_shared<const std::string>(data, len));
+}
 
-                Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Accomodating LogFile Treatment of TP IP: ", ip);	
-
-                char nFile[75];
-
-                while(1) { //Keep receiving name of files
-                    
-                    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Waiting to receive filename from TP IP: ", ip);
-
-                    memset(buffer, 0, sizeof(buffer));
-                    iRetRecv = recv(socket_desc, buffer, bufsize, 0);
-
-                    if(	iRetRecv <= 0 ) {
-                        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error in receiving name of file from touchpanel so Disconnecting from TP IP: ",ip);
-                        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Return code of recv was " + CharString(std::to_string(iRetRecv).c_str()) + " from TP IP: ", ip);
-                        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error number is" + CharString(std::to_string(errno).c_str())+" for TP IP: ", ip);
-                        close(socket_desc);
-                        break;
-                    }
-
-                    if(strcmp(buffer, "Event") == 0) { //Start Receiving Event files
-                        switch_to_event = true;
-
-                        sprintf(buffer, ack_drv);
-                        iRetSend = send(socket_desc, buffer, strlen(buffer), 0); 		
-
-                        if(iRetSend <= 0) {
-                            //Error in sending final marker for Log File. Abort this Connection
-                            Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Error in sending marker for LogFile Message to TP IP:", ip);
-                            close(socket_desc);
-                            sock_err = true;
-                            break;
-                        }
-                        
-                        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Receiving event files from now from TP IP: ",ip);
-                        continue;
-                    }
-
-                    if(strlen(buffer) >= strlen(ack_pnl))
-                        memcpy( subbuffer, &buffer[strlen(buffer) - strlen(ack_pnl)], strlen(ack_pnl));
-
-                    subbuffer[strlen(ack_pnl)] = '\0';
-                    
-                    
-                    if( strcmp(ack_pnl, subbuffer) == 0 ) {
-                        Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "LogFile treatment successfully finished for TP IP:", ip);
-                        break;
-                    }
-
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,CharString("From TP IP: ") + ip + CharString("Received Full File Name: "), buffer);
-
-                    if(switch_to_event)
-                        strcpy(nFile, (Common::Constants::getEventFilePath()).c_str());
-                    else
-                        strcpy(nFile, (Common::Constants::getMeasFilePath()).c_str());
-                    
-                    memcpy(&(buffer[strlen(buffer) - 3]), "dat", 3); //Replace .log extension with .dat extension
-                    strcat(nFile, buffer);
-                
-                    //fpLog = fopen(nFile, "w");
-                    std::ofstream file(nFile); 
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Received file location: " + CharString(nFile) + " From TP IP: ",ip);
-
-
-                    if(!file.is_open()) {
-                        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in creating new file for file reception from Touch Panel for TP IP", ip);
-                        close(socket_desc);
-                        sock_err = true;
-                        break;
-                    }
-
-                    sprintf(buffer, ack_drv);
-                    
-                    iRetSend = send(socket_desc, buffer, strlen(buffer), 0); 		
-
-                    if(iRetSend <= 0) {
-                        //Error in sending final marker for Log File. Abort this Connection
-                        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in sending marker for File Name reception for TP IP:", ip);
-                        close(socket_desc);
-                        //fclose(fpLog);
-                        file.close();
-                        sock_err = true;
-                        break;
-                    }
-                    
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Sent confirmation marker of file name reception: ##DRV_ACK## to TP IP:",ip);
-
-                    Common::Logger::globalInfo(Common::Logger::L2, "File content:\n\n");
-                    
-                    subbuffer[0] = '0';
-                    count = 0;
-
-                    sock_err = false;
-                    
-                    while( strcmp(ack_pnl, subbuffer) != 0 ) {
-                        count++;
-                        Common::Logger::globalInfo(Common::Logger::L2, "Inside loop\n");
-                        Common::Logger::globalInfo(Common::Logger::L2, "Count is "+ CharString(count) + "and sizeof buffer is "+ (std::to_string(sizeof(buffer))).c_str());	
-                        //Common::Logger::globalInfo(Common::Logger::L1, "After memset of buffer to 0\n");
-                        std::memset(buffer, 0, sizeof(buffer));
-
-                        Common::Logger::globalInfo(Common::Logger::L2, "Before receive on the socket\n");
-                        if( recv(socket_desc, buffer, bufsize - 1 , 0) <= 0) { //Keep space for 1 termination char
-                            Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in socket connection with TP IP: ",ip);
-                            close(socket_desc);
-                            sock_err = true;
-                            file.close();
-                            break;
-                        }
-                        
-                        //Common::Logger::globalInfo(Common::Logger::L1, "Packet number "<<count<<" is : "<<buffer;
-                        
-                        //Common::Logger::globalInfo(Common::Logger::L1, "Before next packet print\n");
-                        Common::Logger::globalInfo(Common::Logger::L2, "Packet number ", std::to_string(count).c_str());
-                        Common::Logger::globalInfo(Common::Logger::L2, " is : ", buffer);
-
-                        Common::Logger::globalInfo(Common::Logger::L2, "strlen of buffer is :", std::to_string(strlen(buffer)).c_str());
-
-                        //Common::Logger::globalInfo(Common::Logger::L1, "strlen is "<<strlen(buffer));
-
-                        if(strlen(buffer) >= strlen(ack_pnl))
-                            memcpy( subbuffer, &buffer[strlen(buffer) - strlen(ack_pnl)], strlen(ack_pnl));
-                        else {
-                            if(strlen(lastMsg) >= (strlen(ack_pnl) - strlen(buffer))) {
-                                Common::Logger::globalInfo(Common::Logger::L2, "lastmsg is \n: ", lastMsg);
-                                memcpy(subbuffer, &lastMsg[strlen(lastMsg) - (strlen(ack_pnl) - strlen(buffer))], strlen(ack_pnl) - strlen(buffer));
-                                strcpy(&subbuffer[strlen(ack_pnl) - strlen(buffer)], buffer);
-                            }
-                        }
-
-                        strcpy(lastMsg, buffer);
-                        buffer[strlen(buffer)] = '\0';
-                        lastMsg[strlen(buffer)] = '\0';
-                        subbuffer[strlen(ack_pnl)] = '\0';
-
-                        Common::Logger::globalInfo(Common::Logger::L2, "After packet print\n");
-                        
-                        Common::Logger::globalInfo(Common::Logger::L2, "Subbuffer is ",subbuffer);
-                        if( strcmp("##PNL_ACK##", subbuffer) != 0 ) {
-                            //fprintf( fpLog, "%s", buffer);
-                            file<<buffer;	
-                            Common::Logger::globalInfo(Common::Logger::L2, "Written to file\n");
-                        } else {
-                            if(strlen(buffer) >= strlen(ack_pnl)) {                           
-                                buffer[strlen(buffer) - strlen(ack_pnl)] = '\0';
-                                file<<buffer;	
-                            } else {
-                                std::ifstream rFile(nFile); 
-                                std::stringstream dupBuffer;
-                                dupBuffer << rFile.rdbuf();
-
-                                std::string contents = dupBuffer.str();
-
-                                rFile.close();
-                                
-                                for(unsigned int i=0; i <(strlen(ack_pnl) - strlen(buffer)); i++)
-                                    contents.pop_back();
-                                
-                                file.seekp(0);
-                                file<<contents;
-                                Common::Logger::globalInfo(Common::Logger::L2, CharString("Did not write this msg to file and deleted the last ") + (std::to_string((strlen(ack_pnl) - strlen(buffer)))).c_str() + CharString(" characters from the file\n"));
-                            }
-
-                            //fprintf( fpLog, "%s", buffer);
-                        } 		
-                        Common::Logger::globalInfo(Common::Logger::L2, "After subbuffer comparison\n");
-                        //Common::Logger::globalInfo(Common::Logger::L1, "Subbuffer is : "<<subbuffer));
-                        /* 
-                        if(count == 15) {
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[0] = "<<buffer[0]);
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[1] = "<<buffer[1]); 
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[2] = "<<buffer[2]); 
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[3] = "<<buffer[3]);
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[4] = "<<buffer[4]);
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[5] = "<<buffer[5]);
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[6] = "<<buffer[6]);
-                            Common::Logger::globalInfo(Common::Logger::L1, "buffer[7] = "<<buffer[7]); 
-                        }*/
-                    }	
-                    
-                    if(sock_err) {
-                        break;
-                    }
-
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"File reading completed for TP IP", ip);
-                
-                    sprintf(buffer, "##DRV_ACK##\n\n");
-                    
-                    iRetSend = send(socket_desc, buffer, strlen(buffer), 0); 		
-
-                    if(iRetSend <= 0) {
-                        //Error in sending final marker for Log File. Abort this Connection
-                        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__,"Error in sending final marker for Log File to TP IP:", ip);
-                        close(socket_desc);
-                        file.close();
-                        //fclose(fpLog);
-                        break;
-                    }
-                    
-                    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Sent confirmation marker of file receipt: ##DRV_ACK## to TP IP: ", ip);
-                    
-                    file.close();
-
-                    //fclose(fpLog);
-                } //While loop - keep receiving log file names
-            }
+bool RAMS7200Panel::queueSend(std::shared_ptr<const std::string> data) {
+    if(!data->empty()) {
+        _out.emplace_back(std::move(data), 0);
+    }
+    return flush();
+}
 
-            if(sock_err) 
-                break;
-        } //Inner while(1) loop - waiting for hanshake initiation from the touch panel
+bool RAMS7200Panel::flush() {
+    static const size_t MAX_SEGMENTS = 16;
+    struct iovec iov[MAX_SEGMENTS];
 
-        close(socket_desc);      	
+    while(!_out.empty()) {
+        size_t count = 0;
+        for(auto it = _out.begin(); it != _out.end() && count < MAX_SEGMENTS; ++it, ++count) {
+            iov[count].iov_base = const_cast<char*>(it->first->data() + it->second);
+            iov[count].iov_len = it->first->size() - it->second;
+        }
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+
+        ssize_t iRetSend = sendmsg(_fd, &msg, MSG_NOSIGNAL);
+        if(iRetSend < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            // Resume on EPOLLOUT
+            break;
+        }
+        if(iRetSend <= 0) {
+            return false;
+        }
 
-    } //Outermost while(1) loop - always trying to connect.
+        size_t sent = iRetSend;
+        while(sent > 0) {
+            const size_t left = _out.front().first->size() - _out.front().second;
+            if(sent < left) {
+                _out.front().second += sent;
+                break;
+            }
+            sent -= left;
+            _out.pop_front();
+        }
+        if(_state == State::USER_SYNC) {
+            _deadline = std::chrono::steady_clock::now() + RECEIVE_TIMEOUT;
+        }
+    }
+    updateInterest();
+    return true;
 }
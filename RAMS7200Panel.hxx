@@ -1,11 +1,21 @@
 #pragma once
-#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
 #include "RAMS7200MS.hxx"
+#include "RAMS7200UserFile.hxx"
 #include "Common/Logger.hxx"
+#include "Common/DelimiterMatcher.hxx"
 
 using queueToDPCallback = std::function<void(const std::string& dp_address, uint16_t length, char* payload)>;
 
-
+/**
+ * @brief The RAMS7200Panel class is the non-blocking file sharing state machine of one touch panel.
+ * It does not own a thread: all panels are driven by a single RAMS7200PanelLoop (epoll + timers).
+ */
 class RAMS7200Panel{
 
 public:
@@ -13,28 +23,98 @@ public:
      * @brief RAMS7200Panel constructor
      * @param RAMS7200MS & : const reference to the MS object
      * @param queueToDPCallback : a callback that will be called after each poll
+     * @param int : epoll instance the panel socket gets registered to
+     * @param int : file sharing port of the touch panel
+     * @param RAMS7200UserFile & : encrypted User file shared by all panels
+     * @param std::vector<char> & : receive buffer for file content, shared by the panels of the loop
      * */
-    RAMS7200Panel(RAMS7200MS& , queueToDPCallback);
+    RAMS7200Panel(RAMS7200MS& , queueToDPCallback, int epollFd, int port, RAMS7200UserFile& userFile, std::vector<char>& rxBuffer);
     RAMS7200Panel(const RAMS7200Panel&) = delete;
     RAMS7200Panel& operator=(const RAMS7200Panel&) = delete;
     RAMS7200Panel(RAMS7200Panel&&) = delete;
     RAMS7200Panel& operator=(RAMS7200Panel&&) = delete;
-    ~RAMS7200Panel() = default;
+    ~RAMS7200Panel();
+
+    /**
+     * @brief Handles the epoll events reported for the panel socket
+     */
+    void onEvents(uint32_t events);
+
+    /**
+     * @brief Checks redundancy state and expired timers. Called by the loop at every iteration.
+     * @return false once the MS is not running anymore and the panel can be dropped
+     */
+    bool tick(std::chrono::steady_clock::time_point now);
+
+    std::chrono::steady_clock::time_point getDeadline() const {return _deadline;}
+    const RAMS7200MS& getMS() const {return ms;}
 
-    template <typename T>
-    void sleep_for(T duration)
-    {
-        std::unique_lock<std::mutex> lk(ms._threadMutex);
-        ms._threadCv.wait_for(lk, duration, [&](){
-           return !ms._run.load();     
-        });
-    }
-    void FileSharingTask(int port);
-    
 private:
+    enum class State
+    {
+        PASSIVE,        // Server is passive (redundant systems), no connection
+        BACKOFF,        // Waiting before the next connection attempt
+        CONNECTING,     // Non blocking connect in progress
+        HANDSHAKE,      // Waiting for the handshake number
+        COMMAND,        // Waiting for "User" or "LogFile"
+        USER_SYNC,      // Sending the encrypted User file
+        LOGFILE_NAME,   // Waiting for a file name, "Event" or ##PNL_ACK##
+        LOGFILE_DATA    // Receiving file content until ##PNL_ACK##
+    };
+
     void writeTouchConnErrDPE(bool);
-    
+
+    void connect();
+    void onConnectCompleted();
+    void onConnected();
+    void onReadable();
+    void onTimeout();
+    void scheduleReconnect();
+    void disconnect(const char* reason);
+    void closeSocket();
+    void expectHandshake();
+    void expect(State state);
+
+    void startUserSync();
+    void finishUserSync();
+    void startFileReception();
+    bool handleFileData(const char* data, size_t len, bool& complete);
+    bool finishFileReception();
+    void discardFile();
+
+    bool queueSend(const char* data, size_t len);
+    bool queueSend(std::shared_ptr<const std::string> data);
+    bool flush();
+    void updateInterest();
+    ssize_t receive(char* buffer, size_t len);
+
     RAMS7200MS& ms;
     bool touch_panel_conn_error = true; //Not connected initially
+    bool _connErrPublished{false};
     queueToDPCallback _queueToDPCB;
-};
\ No newline at end of file
+
+    const int _epollFd;
+    const int _port;
+    RAMS7200UserFile& _userFile;
+    std::vector<char>& _rxBuffer;
+    int _fd{-1};
+    uint32_t _interest{0};
+    State _state{State::BACKOFF};
+    std::chrono::steady_clock::time_point _deadline{std::chrono::steady_clock::now()};
+    int _connectTryCount{0};
+
+    static const int bufsize = 1024;
+    char _buffer[bufsize];
+    // Pending writes (segment, bytes already sent), flushed with scatter/gather sends
+    std::deque<std::pair<std::shared_ptr<const std::string>, size_t>> _out;
+
+    // File being received: written under _tmpFileName, renamed to _fileName once complete
+    int _fileFd{-1};
+    std::string _fileName;
+    std::string _tmpFileName;
+    size_t _fileBytes{0};
+    std::chrono::steady_clock::time_point _fileStart;
+    Common::DelimiterMatcher _fileEnd{"##PNL_ACK##"};
+    bool _switchToEvent{false};
+    int _count{0};
+};
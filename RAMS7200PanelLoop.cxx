@@ -0,0 +1,129 @@
+#include "RAMS7200PanelLoop.hxx"
+#include "Common/Logger.hxx"
+#include <algorithm>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Upper bound of an epoll wait, so that redundancy switches and stopped MSs are noticed
+static const auto MAX_WAIT = std::chrono::milliseconds(1000);
+static const int MAX_EVENTS = 64;
+static const size_t RX_BUFFER_SIZE = 64 * 1024;
+
+RAMS7200PanelLoop::RAMS7200PanelLoop(queueToDPCallback cb, int port)
+    : _queueToDPCB(cb), _port(port), _rxBuffer(RX_BUFFER_SIZE)
+{}
+
+RAMS7200PanelLoop::~RAMS7200PanelLoop()
+{
+    stop();
+}
+
+void RAMS7200PanelLoop::start()
+{
+    if(_run.load()) {
+        return;
+    }
+
+    _epollFd = epoll_create1(EPOLL_CLOEXEC);
+    _wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(_epollFd == -1 || _wakeFd == -1) {
+        Common::Logger::globalError(__PRETTY_FUNCTION__, "Could not create the epoll instance for the touch panels");
+        return;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    epoll_ctl(_epollFd, EPOLL_CTL_ADD, _wakeFd, &ev);
+
+    _run.store(true);
+    _thread = std::thread([this]() { this->run(); });
+}
+
+void RAMS7200PanelLoop::stop()
+{
+    if(!_run.exchange(false)) {
+        return;
+    }
+    wakeUp();
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+    close(_wakeFd);
+    close(_epollFd);
+    _wakeFd = _epollFd = -1;
+}
+
+void RAMS7200PanelLoop::addPanel(RAMS7200MS& ms)
+{
+    {
+        std::lock_guard<std::mutex> lock{_pendingMutex};
+        _pending.push_back(&ms);
+    }
+    wakeUp();
+}
+
+void RAMS7200PanelLoop::wakeUp()
+{
+    uint64_t one = 1;
+    if(_wakeFd != -1 && write(_wakeFd, &one, sizeof(one)) < 0) {
+        Common::Logger::globalInfo(Common::Logger::L2, __PRETTY_FUNCTION__, "Could not wake up the panel loop");
+    }
+}
+
+void RAMS7200PanelLoop::adoptPendingPanels()
+{
+    std::vector<RAMS7200MS*> pending;
+    {
+        std::lock_guard<std::mutex> lock{_pendingMutex};
+        pending.swap(_pending);
+    }
+
+    for(auto ms : pending) {
+        const bool known = std::any_of(_panels.begin(), _panels.end(), [ms](const std::unique_ptr<RAMS7200Panel>& panel){
+            return &(panel->getMS()) == ms;
+        });
+        if(!known) {
+            Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Serving PANEL IP:" + CharString(ms->_tp_ip.c_str()));
+            _panels.emplace_back(new RAMS7200Panel(*ms, _queueToDPCB, _epollFd, _port, _userFile, _rxBuffer));
+        }
+    }
+}
+
+void RAMS7200PanelLoop::run()
+{
+    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Panel loop up");
+    struct epoll_event events[MAX_EVENTS];
+
+    while(_run.load()) {
+        adoptPendingPanels();
+
+        // Timers: fire expired deadlines and find the next one
+        const auto now = std::chrono::steady_clock::now();
+        auto next = now + MAX_WAIT;
+        for(auto it = _panels.begin(); it != _panels.end(); ) {
+            if(!(*it)->tick(now)) {
+                it = _panels.erase(it);
+                continue;
+            }
+            next = std::min(next, (*it)->getDeadline());
+            ++it;
+        }
+
+        const auto timeout = std::chrono::duration_cast<std::chrono::milliseconds>(next - std::chrono::steady_clock::now()).count();
+        const int n = epoll_wait(_epollFd, events, MAX_EVENTS, timeout > 0 ? static_cast<int>(timeout) : 0);
+
+        for(int i = 0; i < n; i++) {
+            if(events[i].data.ptr == nullptr) {
+                uint64_t count;
+                while(read(_wakeFd, &count, sizeof(count)) > 0);
+                continue;
+            }
+            static_cast<RAMS7200Panel*>(events[i].data.ptr)->onEvents(events[i].events);
+        }
+    }
+
+    _panels.clear();
+    Common::Logger::globalInfo(Common::Logger::L1,__PRETTY_FUNCTION__, "Panel loop down");
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "RAMS7200Panel.hxx"
+
+/**
+ * @brief The RAMS7200PanelLoop class drives the file sharing of all touch panels from a single thread.
+ * Sockets are multiplexed with epoll and every wait (connect, backoff, receive) is a panel deadline.
+ */
+class RAMS7200PanelLoop
+{
+public:
+    /**
+     * @brief RAMS7200PanelLoop constructor
+     * @param queueToDPCallback : callback handed over to every panel
+     * @param int : file sharing port of the touch panels
+     * */
+    RAMS7200PanelLoop(queueToDPCallback, int port);
+    RAMS7200PanelLoop(const RAMS7200PanelLoop&) = delete;
+    RAMS7200PanelLoop& operator=(const RAMS7200PanelLoop&) = delete;
+    ~RAMS7200PanelLoop();
+
+    void start();
+    void stop();
+
+    /**
+     * @brief Serves the touch panel of the MS. Thread safe, no-op if the MS is already served.
+     */
+    void addPanel(RAMS7200MS& ms);
+
+private:
+    void run();
+    void wakeUp();
+    void adoptPendingPanels();
+
+    queueToDPCallback _queueToDPCB;
+    const int _port;
+    int _epollFd{-1};
+    int _wakeFd{-1};
+    std::atomic<bool> _run{false};
+    std::thread _thread;
+
+    std::mutex _pendingMutex;
+    std::vector<RAMS7200MS*> _pending;
+
+    RAMS7200UserFile _userFile;
+    // Panels are served one at a time and write through, so a single large receive buffer is enough
+    std::vector<char> _rxBuffer;
+
+    // Only accessed from the loop thread
+    std::vector<std::unique_ptr<RAMS7200Panel>> _panels;
+};
@@ -23,14 +23,27 @@
 const CharString RAMS7200Resources::SECTION_NAME = "rams7200";
 const CharString RAMS7200Resources::TSAP_PORT_LOCAL = "localTSAP";
 const CharString RAMS7200Resources::TSAP_PORT_REMOTE = "remoteTSAP";
+const CharString RAMS7200Resources::PLC_PORT = "plcPort";
 const CharString RAMS7200Resources::POLLING_INTERVAL = "pollingInterval";
 const CharString RAMS7200Resources::MEASUREMENT_PATH = "mesFile";
 const CharString RAMS7200Resources::EVENT_PATH = "eventFile";
 const CharString RAMS7200Resources::USERFILE_PATH = "userFile";
-
- std::string Common::Constants::MEASUREMENT_PATH;
- std::string Common::Constants::EVENT_PATH;
-std::string Common::Constants::USERFILE_PATH;
+const CharString RAMS7200Resources::FILE_SYNC_POLICY = "fileSync";
+const CharString RAMS7200Resources::ASYNC_LOG_QUEUE = "asyncLogQueue";
+const CharString RAMS7200Resources::STATS_INTERVAL = "statsInterval";
+const CharString RAMS7200Resources::TRACE_EVENTS = "traceEvents";
+const CharString RAMS7200Resources::TRACE_PATH = "tracePath";
+const CharString RAMS7200Resources::WARM_STANDBY = "warmStandby";
+const CharString RAMS7200Resources::CONNECT_TIMEOUT = "connectTimeout";
+const CharString RAMS7200Resources::IO_TIMEOUT = "ioTimeout";
+const CharString RAMS7200Resources::PLC_TIMEOUT = "plcTimeout";
+const CharString RAMS7200Resources::RECONNECT_MAX = "reconnectMax";
+const CharString RAMS7200Resources::LAST_VALUE_PATH = "lastValuePath";
+const CharString RAMS7200Resources::MIDPOINT_TIMESTAMPS = "midpointTimestamps";
+const CharString RAMS7200Resources::DELIVERY_QUEUE_SIZE = "deliveryQueueSize";
+const CharString RAMS7200Resources::DELIVERY_OVERFLOW = "deliveryOverflow";
+const CharString RAMS7200Resources::JOURNAL_PATH = "journalPath";
+const CharString RAMS7200Resources::BURST_SAMPLES = "burstSamples";
 
 //-------------------------------------------------------------------------------
 // init is a wrapper around begin, readSection and end
@@ -71,6 +84,9 @@ PVSSboolean RAMS7200Resources::readSection() {
 			}else if(keyWord.startsWith(TSAP_PORT_REMOTE)) {
 				cfgStream >> tmpStr;
 				Common::Constants::setRemoteTsapPort(strtol(tmpStr.c_str(), NULL, 16));
+			}else if(keyWord.startsWith(PLC_PORT)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setPlcPort(atoi(tmpStr.c_str()));
 			}else if(keyWord.startsWith(POLLING_INTERVAL)) {
 				cfgStream >> tmpStr;
 				Common::Constants::setPollingInterval(atoi(tmpStr.c_str()));
@@ -83,6 +99,55 @@ PVSSboolean RAMS7200Resources::readSection() {
       		}else if(keyWord.startsWith(USERFILE_PATH)) {
 				cfgStream >> tmpStr;
 				Common::Constants::setUserFilePath(tmpStr);
+      		}else if(keyWord.startsWith(FILE_SYNC_POLICY)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setFileSyncPolicy(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(ASYNC_LOG_QUEUE)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setAsyncLogQueueSize(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(STATS_INTERVAL)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setStatsInterval(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(TRACE_EVENTS)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setTraceEvents(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(TRACE_PATH)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setTracePath(tmpStr);
+      		}else if(keyWord.startsWith(WARM_STANDBY)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setWarmStandby(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(CONNECT_TIMEOUT)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setConnectTimeout(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(IO_TIMEOUT)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setIoTimeout(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(PLC_TIMEOUT)) {
+				std::string connectTimeout, ioTimeout;
+				cfgStream >> tmpStr >> connectTimeout >> ioTimeout;
+				Common::Constants::setPlcTimeouts(tmpStr, atoi(connectTimeout.c_str()), atoi(ioTimeout.c_str()));
+      		}else if(keyWord.startsWith(RECONNECT_MAX)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setReconnectMax(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(LAST_VALUE_PATH)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setLastValuePath(tmpStr);
+      		}else if(keyWord.startsWith(MIDPOINT_TIMESTAMPS)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setMidpointTimestamps(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(DELIVERY_QUEUE_SIZE)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setDeliveryQueueSize(atoi(tmpStr.c_str()));
+      		}else if(keyWord.startsWith(DELIVERY_OVERFLOW)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setDeliveryOverflow(tmpStr);
+      		}else if(keyWord.startsWith(JOURNAL_PATH)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setJournalPath(tmpStr);
+      		}else if(keyWord.startsWith(BURST_SAMPLES)) {
+				cfgStream >> tmpStr;
+				Common::Constants::setBurstSamples(atoi(tmpStr.c_str()));
       		}
 
 			getNextEntry();
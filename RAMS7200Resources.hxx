@@ -43,10 +43,27 @@ class RAMS7200Resources : public DrvRsrce
     static const CharString SECTION_NAME;
     static const CharString TSAP_PORT_LOCAL;
     static const CharString TSAP_PORT_REMOTE;
+    static const CharString PLC_PORT;
     static const CharString POLLING_INTERVAL;
     static const CharString MEASUREMENT_PATH;
     static const CharString EVENT_PATH;
     static const CharString USERFILE_PATH;
+    static const CharString FILE_SYNC_POLICY;
+    static const CharString ASYNC_LOG_QUEUE;
+    static const CharString STATS_INTERVAL;
+    static const CharString TRACE_EVENTS;
+    static const CharString TRACE_PATH;
+    static const CharString WARM_STANDBY;
+    static const CharString CONNECT_TIMEOUT;
+    static const CharString IO_TIMEOUT;
+    static const CharString PLC_TIMEOUT;
+    static const CharString RECONNECT_MAX;
+    static const CharString LAST_VALUE_PATH;
+    static const CharString MIDPOINT_TIMESTAMPS;
+    static const CharString DELIVERY_QUEUE_SIZE;
+    static const CharString DELIVERY_OVERFLOW;
+    static const CharString JOURNAL_PATH;
+    static const CharString BURST_SAMPLES;
 };
 
 #endif
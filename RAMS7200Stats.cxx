@@ -0,0 +1,194 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200Stats.hxx"
+#include "Common/Constants.hxx"
+#include "Common/Logger.hxx"
+#include "Common/Utils.hxx"
+#include <cstring>
+#include <sstream>
+
+static double toMs(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// Values are queued in PLC (big endian) byte order, like the polled ones, for the Int32/Float transformations
+static void publishInt(const std::string& address, const queueToDPCallback& cb, int32_t value)
+{
+    const int32_t swapped = Common::Utils::CopyNSwapBytes<int32_t>(value);
+    auto pdata = new char[sizeof(int32_t)];
+    memcpy(pdata, &swapped, sizeof(int32_t));
+    cb(address, sizeof(int32_t), pdata);
+}
+
+static void publishFloat(const std::string& address, const queueToDPCallback& cb, float value)
+{
+    const float swapped = Common::Utils::CopyNSwapBytes<float>(value);
+    auto pdata = new char[sizeof(float)];
+    memcpy(pdata, &swapped, sizeof(float));
+    cb(address, sizeof(float), pdata);
+}
+
+static void publishPercentiles(const std::string& address, const queueToDPCallback& cb, const Common::LatencyHistogram::Snapshot& s)
+{
+    publishFloat(address + "P50", cb, s.percentileMs(50));
+    publishFloat(address + "P90", cb, s.percentileMs(90));
+    publishFloat(address + "P99", cb, s.percentileMs(99));
+    publishFloat(address + "P999", cb, s.percentileMs(99.9));
+    publishFloat(address + "Max", cb, s.percentileMs(100));
+}
+
+static void dumpPercentiles(const std::string& name, const Common::LatencyHistogram::Snapshot& s)
+{
+    std::stringstream ss;
+    ss << name << ": n=" << s.count() << " p50=" << s.percentileMs(50) << " p90=" << s.percentileMs(90)
+       << " p99=" << s.percentileMs(99) << " p99.9=" << s.percentileMs(99.9) << " max=" << s.percentileMs(100) << " ms";
+    Common::Logger::globalInfo(Common::Logger::L1, "Latency", ss.str().c_str());
+}
+
+void RAMS7200Latencies::publish(const std::string& prefix, const queueToDPCallback& cb)
+{
+    publishPercentiles(prefix + "_latS7Rtt", cb, s7Rtt.interval());
+    publishPercentiles(prefix + "_latDelivery", cb, delivery.interval());
+    publishPercentiles(prefix + "_latWriteAck", cb, writeAck.interval());
+}
+
+void RAMS7200Latencies::dump(const std::string& name) const
+{
+    dumpPercentiles(name + " S7 round trip", s7Rtt.snapshot());
+    dumpPercentiles(name + " acquisition to toDp", delivery.snapshot());
+    dumpPercentiles(name + " writeData to PLC ack", writeAck.snapshot());
+}
+
+RAMS7200Latencies& RAMS7200Stats::globalLatencies()
+{
+    static RAMS7200Latencies global;
+    return global;
+}
+
+void RAMS7200Stats::publishGlobalIfDue(const queueToDPCallback& cb, RAMS7200DeliveryQueue& queue)
+{
+    static clock::time_point periodStart = clock::now();
+    const auto interval = std::chrono::seconds(Common::Constants::getStatsInterval());
+    const auto now = clock::now();
+    if(interval.count() == 0 || now - periodStart < interval) {
+        return;
+    }
+    periodStart = now;
+    globalLatencies().publish("", cb);
+
+    // Taken before queueing the values, which locks the queue again
+    static RAMS7200DeliveryQueue::Counters last{0, 0, 0};
+    const auto counters = queue.counters();
+    publishInt("_queueBuffered", cb, static_cast<int32_t>(counters.buffered));
+    publishInt("_queueDropped", cb, static_cast<int32_t>(counters.dropped - last.dropped));
+    publishInt("_queueSpilled", cb, static_cast<int32_t>(counters.spilled - last.spilled));
+    last = counters;
+}
+
+void RAMS7200Stats::cycle(clock::duration duration, bool overrun)
+{
+    ++_cycles;
+    _cycleTotal += duration;
+    if(duration > _cycleMax) {
+        _cycleMax = duration;
+    }
+    if(overrun) {
+        ++_overruns;
+    }
+}
+
+void RAMS7200Stats::request(uint32_t items, uint32_t pduBytes, uint32_t pduSize, bool write, bool ok)
+{
+    ++_requests;
+    _requestItems += items;
+    _pduBytes += pduBytes;
+    _pduCapacity += pduSize;
+    if(!ok) {
+        // The whole request failed: none of its items made it
+        (write ? _writeErrors : _readErrors) += items;
+    }
+}
+
+void RAMS7200Stats::itemTransferred(uint32_t dataBytes, bool write, bool ok)
+{
+    if(!ok) {
+        ++(write ? _writeErrors : _readErrors);
+        return;
+    }
+    (write ? _bytesWritten : _bytesRead) += dataBytes;
+}
+
+void RAMS7200Stats::s7RoundTrip(clock::duration rtt)
+{
+    _latencies.s7Rtt.record(rtt);
+    globalLatencies().s7Rtt.record(rtt);
+}
+
+void RAMS7200Stats::writeAcknowledged(clock::duration latency)
+{
+    _latencies.writeAck.record(latency);
+    globalLatencies().writeAck.record(latency);
+}
+
+void RAMS7200Stats::queueLatency(clock::duration latency)
+{
+    _latencies.delivery.record(latency);
+    globalLatencies().delivery.record(latency);
+    const auto count = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+    const uint64_t us = count > 0 ? static_cast<uint64_t>(count) : 0;
+    _latencyCount.fetch_add(1, std::memory_order_relaxed);
+    _latencyTotalUs.fetch_add(us, std::memory_order_relaxed);
+    uint64_t max = _latencyMaxUs.load(std::memory_order_relaxed);
+    while(us > max && !_latencyMaxUs.compare_exchange_weak(max, us, std::memory_order_relaxed));
+}
+
+void RAMS7200Stats::publishIfDue(const std::string& ip_combo, const queueToDPCallback& cb, int ioFailures)
+{
+    const auto interval = std::chrono::seconds(Common::Constants::getStatsInterval());
+    const auto now = clock::now();
+    if(interval.count() == 0 || now - _periodStart < interval) {
+        return;
+    }
+
+    const std::string prefix = ip_combo + "$_stat";
+    const uint64_t latencyCount = _latencyCount.exchange(0, std::memory_order_relaxed);
+    const uint64_t latencyTotalUs = _latencyTotalUs.exchange(0, std::memory_order_relaxed);
+    const uint64_t latencyMaxUs = _latencyMaxUs.exchange(0, std::memory_order_relaxed);
+
+    publishFloat(prefix + "CycleMs", cb, _cycles ? toMs(_cycleTotal) / _cycles : 0.0);
+    publishFloat(prefix + "CycleMaxMs", cb, toMs(_cycleMax));
+    publishInt(prefix + "Overruns", cb, _overruns);
+    publishFloat(prefix + "RequestsPerCycle", cb, _cycles ? static_cast<double>(_requests) / _cycles : 0.0);
+    publishFloat(prefix + "ItemsPerRequest", cb, _requests ? static_cast<double>(_requestItems) / _requests : 0.0);
+    publishFloat(prefix + "PduFill", cb, _pduCapacity ? 100.0 * _pduBytes / _pduCapacity : 0.0);
+    publishInt(prefix + "BytesRead", cb, static_cast<int32_t>(_bytesRead));
+    publishInt(prefix + "BytesWritten", cb, static_cast<int32_t>(_bytesWritten));
+    publishInt(prefix + "ReadErrors", cb, _readErrors);
+    publishInt(prefix + "WriteErrors", cb, _writeErrors);
+    publishInt(prefix + "IoFailures", cb, ioFailures);
+    publishInt(prefix + "Reconnects", cb, _reconnects);
+    publishFloat(prefix + "QueueLatencyMs", cb, latencyCount ? latencyTotalUs / 1000.0 / latencyCount : 0.0);
+    publishFloat(prefix + "QueueLatencyMaxMs", cb, latencyMaxUs / 1000.0);
+    _latencies.publish(ip_combo + "$", cb);
+
+    LOGGER_INFO(Common::Logger::L2, __PRETTY_FUNCTION__, "Statistics published for PLC IP:", ip_combo.c_str());
+
+    // The latency counters were reset above, workProc may already be filling them again
+    _periodStart = now;
+    _cycles = 0;
+    _cycleTotal = _cycleMax = clock::duration::zero();
+    _overruns = _requests = _readErrors = _writeErrors = _reconnects = 0;
+    _requestItems = _pduBytes = _pduCapacity = _bytesRead = _bytesWritten = 0;
+}
+
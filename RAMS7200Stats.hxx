@@ -0,0 +1,110 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "Common/LatencyHistogram.hxx"
+#include "RAMS7200DeliveryQueue.hxx"
+
+using queueToDPCallback = std::function<void(const std::string& dp_address, uint16_t length, char* payload)>;
+
+/**
+ * @brief Latency distributions, kept per PLC and for the whole driver
+ */
+struct RAMS7200Latencies
+{
+    Common::LatencyHistogram s7Rtt;     // ReadMultiVars/WriteMultiVars/ReadArea/WriteArea round trip
+    Common::LatencyHistogram delivery;  // value acquired from the PLC -> toDp in workProc
+    Common::LatencyHistogram writeAck;  // writeData -> write acknowledged by the PLC
+
+    /**
+     * @brief Publishes the percentiles of the last interval as <prefix>_lat<Name><P50|P90|P99|P999|Max>
+     */
+    void publish(const std::string& prefix, const queueToDPCallback& cb);
+
+    /**
+     * @brief Logs the percentiles since driver start at level 1
+     */
+    void dump(const std::string& name) const;
+};
+
+/**
+ * @brief Performance counters of one PLC, published as internal DPEs <IP_COMBO>$_stat<Name>
+ * every statsInterval seconds. Counts are per interval, durations are interval averages/maxima.
+ *
+ * Everything is updated by the PLC thread, except the queue latency which is measured by
+ * workProc (hence atomic, the histograms are lock free).
+ */
+class RAMS7200Stats
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    // PLC thread
+    void cycle(clock::duration duration, bool overrun);
+    void request(uint32_t items, uint32_t pduBytes, uint32_t pduSize, bool write, bool ok);
+    void itemTransferred(uint32_t dataBytes, bool write, bool ok);
+    void reconnect() {++_reconnects;}
+    void s7RoundTrip(clock::duration rtt);
+    void writeAcknowledged(clock::duration latency);
+
+    // workProc
+    void queueLatency(clock::duration latency);
+
+    /**
+     * @brief Publishes and resets the interval counters once the configured interval has elapsed
+     * @param ioFailures : current consecutive I/O failures of the connection
+     */
+    void publishIfDue(const std::string& ip_combo, const queueToDPCallback& cb, int ioFailures);
+
+    const RAMS7200Latencies& latencies() const {return _latencies;}
+
+    // Counters of the current interval, since start when statsInterval is 0. Owned by the PLC thread.
+    uint32_t cycles() const {return _cycles;}
+    uint32_t overruns() const {return _overruns;}
+    uint32_t requests() const {return _requests;}
+    uint32_t readErrors() const {return _readErrors;}
+    clock::duration cycleMax() const {return _cycleMax;}
+
+    // Every PLC also records in the driver wide histograms, published by workProc as _lat<Name>...
+    // together with the _queue<Name> counters of the delivery queue
+    static RAMS7200Latencies& globalLatencies();
+    static void publishGlobalIfDue(const queueToDPCallback& cb, RAMS7200DeliveryQueue& queue);
+
+private:
+    clock::time_point _periodStart{clock::now()};
+
+    uint32_t _cycles{0};
+    clock::duration _cycleTotal{0};
+    clock::duration _cycleMax{0};
+    uint32_t _overruns{0};
+    uint32_t _requests{0};
+    uint64_t _requestItems{0};
+    uint64_t _pduBytes{0};
+    uint64_t _pduCapacity{0};
+    uint64_t _bytesRead{0};
+    uint64_t _bytesWritten{0};
+    uint32_t _readErrors{0};
+    uint32_t _writeErrors{0};
+    uint32_t _reconnects{0};
+
+    std::atomic<uint64_t> _latencyCount{0};
+    std::atomic<uint64_t> _latencyTotalUs{0};
+    std::atomic<uint64_t> _latencyMaxUs{0};
+
+    RAMS7200Latencies _latencies;
+};
@@ -0,0 +1,107 @@
+#include "RAMS7200UserFile.hxx"
+#include "RAMS7200Encryption.hxx"
+#include "Common/Logger.hxx"
+
+std::shared_ptr<const std::string> RAMS7200UserFile::getEncoded(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock{_mutex};
+
+    struct stat st;
+    if(stat(path.c_str(), &st) != 0) {
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "Cannot stat User File:", path.c_str());
+        return nullptr;
+    }
+    if(isUpToDate(path, st)) {
+        return _payload;
+    }
+
+    FILE* fpUser = fopen(path.c_str(), "r");
+    if(fpUser == NULL) {
+        return nullptr;
+    }
+    // The stamp is taken before reading: if the file is rewritten while encoding, the payload may mix
+    // both contents and is not cached, so that the next sync reads the file again
+    struct stat before, after;
+    if(fstat(fileno(fpUser), &before) != 0) {
+        fclose(fpUser);
+        return nullptr;
+    }
+    std::shared_ptr<std::string> payload(new std::string());
+    const bool encoded = encode(fpUser, *payload);
+    const bool unchanged = fstat(fileno(fpUser), &after) == 0 && sameStamp(before, after);
+    fclose(fpUser);
+    if(!encoded) {
+        return nullptr;
+    }
+
+    Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "User File encoded for the touch panels: " + CharString(path.c_str()), CharString(static_cast<int>(payload->size())) + " bytes");
+    if(!unchanged) {
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "User File changed while encoding, not cached:", path.c_str());
+        _payload.reset();
+        return payload;
+    }
+    _path = path;
+    _stat = before;
+    _payload = payload;
+    return _payload;
+}
+
+bool RAMS7200UserFile::isUpToDate(const std::string& path, const struct stat& st) const
+{
+    return _payload && _path == path && sameStamp(_stat, st);
+}
+
+bool RAMS7200UserFile::sameStamp(const struct stat& a, const struct stat& b)
+{
+    return a.st_ino == b.st_ino &&
+        a.st_size == b.st_size &&
+        a.st_mtim.tv_sec == b.st_mtim.tv_sec &&
+        a.st_mtim.tv_nsec == b.st_mtim.tv_nsec &&
+        a.st_ctim.tv_sec == b.st_ctim.tv_sec &&
+        a.st_ctim.tv_nsec == b.st_ctim.tv_nsec;
+}
+
+bool RAMS7200UserFile::encode(FILE* fpUser, std::string& out) {
+    static const unsigned char key[8] = "123";
+    // The cipher is checked against its known answers and the key scheduled once per process
+    static const bool cipherOk = des_test() == CRYPT_OK;
+    static symmetric_key skey;
+    static const bool keyOk = des_setup(key, /* the key we will use */
+                                        8, /* key is 8 bytes (64-bits) long */
+                                        0, /* 0 == use default # of rounds */
+                                        &skey) /* where to put the scheduled key */
+                                        == CRYPT_OK;
+    if(!cipherOk || !keyOk) {
+        Common::Logger::globalInfo(Common::Logger::L1, __PRETTY_FUNCTION__, "DES self test or key schedule failed");
+        return false;
+    }
+
+    // Up to 4 characters per ciphertext byte
+    struct stat st;
+    if(fstat(fileno(fpUser), &st) == 0) {
+        out.reserve(static_cast<size_t>(st.st_size) * 4 + 64);
+    }
+
+    // Each line is zero padded to 8-byte blocks and encrypted in one call, each ciphertext byte is sent as "%d\n"
+    char line[1024];
+    unsigned char blocks[sizeof(line)];
+    while(fgets(line, sizeof(line), fpUser)) {
+        const size_t len = strlen(line);
+        const size_t count = (len + 7) / 8;
+        memcpy(blocks, line, len);
+        memset(blocks + len, 0, count * 8 - len);
+
+        des_ecb_encrypt_blocks(blocks, blocks, count, &skey);
+
+        for(size_t j = 0; j < count * 8; j++) {
+            const unsigned char c = blocks[j];
+            if(c >= 100)
+                out += static_cast<char>('0' + c / 100);
+            if(c >= 10)
+                out += static_cast<char>('0' + (c / 10) % 10);
+            out += static_cast<char>('0' + c % 10);
+            out += '\n';
+        }
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/stat.h>
+
+/**
+ * @brief The RAMS7200UserFile class keeps the encrypted User file payload sent to the touch panels.
+ * The file is read and encrypted again only when its size, inode or modification time changed,
+ * every panel is served from the same shared buffer.
+ */
+class RAMS7200UserFile
+{
+public:
+    RAMS7200UserFile() = default;
+    RAMS7200UserFile(const RAMS7200UserFile&) = delete;
+    RAMS7200UserFile& operator=(const RAMS7200UserFile&) = delete;
+
+    /**
+     * @brief Gets the encoded payload of the User file
+     * @param path : location of the User file
+     * @return the payload, nullptr if the file cannot be read or encrypted
+     */
+    std::shared_ptr<const std::string> getEncoded(const std::string& path);
+
+    static bool encode(FILE* fpUser, std::string& out);
+
+private:
+    bool isUpToDate(const std::string& path, const struct stat& st) const;
+    // Same inode, size, modification and change times
+    static bool sameStamp(const struct stat& a, const struct stat& b);
+
+    std::mutex _mutex;
+    std::string _path;
+    struct stat _stat;
+    std::shared_ptr<const std::string> _payload;
+};
@@ -0,0 +1,292 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include "RAMS7200Simulator.hxx"
+#include "Common/S7Utils.hxx"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+RAMS7200Simulator::RAMS7200Simulator(Config config)
+    : _config(std::move(config))
+{
+    // V memory of the S7-200 is DB1 (see S7Utils::TS7DataItemFromAddress)
+    _areas.push_back(Area{srvAreaDB, S7AreaDB, std::vector<uint8_t>(65535, 0)});
+    _areas.push_back(Area{srvAreaMK, S7AreaMK, std::vector<uint8_t>(256, 0)});
+    _areas.push_back(Area{srvAreaPE, S7AreaPE, std::vector<uint8_t>(256, 0)});
+    _areas.push_back(Area{srvAreaPA, S7AreaPA, std::vector<uint8_t>(256, 0)});
+}
+
+RAMS7200Simulator::~RAMS7200Simulator()
+{
+    stop();
+}
+
+bool RAMS7200Simulator::loadScript(const std::string& path)
+{
+    std::ifstream file(path);
+    if(!file) {
+        fprintf(stderr, "Cannot open script %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    int number = 0;
+    while(std::getline(file, line)) {
+        ++number;
+        if(!addLine(line)) {
+            fprintf(stderr, "%s:%d: cannot parse '%s'\n", path.c_str(), number, line.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+bool RAMS7200Simulator::addLine(const std::string& line)
+{
+    std::istringstream in(line.substr(0, line.find('#')));
+    std::string address, pattern;
+    if(!(in >> address)) {
+        return true; // empty or comment
+    }
+
+    if(address == "area") {
+        std::string name;
+        uint32_t size = 0;
+        if(!(in >> name >> size) || name.size() != 1 || size == 0 || size > 65535) {
+            return false;
+        }
+        Area* area = findArea(Common::S7Utils::AddressGetArea(name + "B0"));
+        if(!area) {
+            return false;
+        }
+        area->data.assign(size, 0);
+        return true;
+    }
+
+    Signal signal;
+    try {
+        if(!Common::S7Utils::AddressIsValid(address) || !(in >> pattern)) {
+            return false;
+        }
+        signal.item = Common::S7Utils::TS7DataItemFromAddress(address);
+    } catch(std::exception&) {
+        return false;
+    }
+    if(!findArea(signal.item.Area)) {
+        return false;
+    }
+
+    static const std::pair<const char*, Pattern> patterns[] = {
+        {"const", Pattern::CONST}, {"ramp", Pattern::RAMP}, {"sine", Pattern::SINE}, {"counter", Pattern::COUNTER},
+        {"toggle", Pattern::TOGGLE}, {"random", Pattern::RANDOM}, {"text", Pattern::TEXT}
+    };
+    static const int parameters[] = {1, 3, 3, 1, 1, 2, 0};
+    size_t i = 0;
+    while(i < sizeof(parameters) / sizeof(parameters[0]) && pattern != patterns[i].first) {
+        ++i;
+    }
+    if(i == sizeof(parameters) / sizeof(parameters[0])) {
+        return false;
+    }
+    signal.pattern = patterns[i].second;
+    for(int p = 0; p < parameters[i]; p++) {
+        if(!(in >> signal.p[p])) {
+            return false;
+        }
+    }
+    if(signal.pattern == Pattern::TEXT) {
+        std::getline(in >> std::ws, signal.text);
+        if(signal.item.WordLen != S7WLByte) {
+            return false;
+        }
+    }
+    if((signal.pattern == Pattern::RAMP || signal.pattern == Pattern::SINE || signal.pattern == Pattern::TOGGLE) && signal.p[parameters[i] - 1] <= 0) {
+        return false; // period
+    }
+    _signals.push_back(signal);
+    return true;
+}
+
+RAMS7200Simulator::Area* RAMS7200Simulator::findArea(int s7Area)
+{
+    for(auto& area : _areas) {
+        if(area.s7Area == s7Area) {
+            return &area;
+        }
+    }
+    return nullptr;
+}
+
+int RAMS7200Simulator::start()
+{
+    _server.reset(new TS7Server());
+    for(auto& area : _areas) {
+        _server->RegisterArea(area.srvArea, area.srvArea == srvAreaDB ? 1 : 0, area.data.data(), area.data.size());
+    }
+    _server->SetParam(p_u16_LocalPort, &_config.port);
+    _server->SetEventsMask(evcDataRead | evcDataWrite);
+    _server->SetEventsCallback(onEvent, this);
+    tick(0);
+
+    const int result = _server->StartTo(_config.address.c_str());
+    if(result != 0) {
+        return result;
+    }
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _run = true;
+    }
+    _thread = std::thread(&RAMS7200Simulator::run, this);
+    return 0;
+}
+
+void RAMS7200Simulator::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock{_mutex};
+        _run = false;
+    }
+    _cv.notify_all();
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+    if(_server) {
+        _server->Stop();
+        _server.reset();
+    }
+}
+
+void RAMS7200Simulator::run()
+{
+    const auto begin = std::chrono::steady_clock::now();
+    auto nextTick = begin;
+    auto nextDrop = begin + std::chrono::seconds(_config.dropEvery);
+    std::unique_lock<std::mutex> lock{_mutex};
+    while(_run) {
+        nextTick += std::chrono::milliseconds(_config.tickMs);
+        if(_cv.wait_until(lock, nextTick, [this]{ return !_run; })) {
+            break;
+        }
+        const auto now = std::chrono::steady_clock::now();
+        tick(std::chrono::duration<double>(now - begin).count());
+        if(_config.dropEvery > 0 && now >= nextDrop) {
+            // Like a PLC reboot: every client has to reconnect
+            _server->Stop();
+            _server->StartTo(_config.address.c_str());
+            ++_drops;
+            nextDrop = now + std::chrono::seconds(_config.dropEvery);
+        }
+    }
+}
+
+void RAMS7200Simulator::tick(double seconds)
+{
+    const double pi = std::acos(-1.0);
+    for(const auto& signal : _signals) {
+        double value = 0;
+        switch(signal.pattern) {
+            case Pattern::CONST:   value = signal.p[0]; break;
+            case Pattern::RAMP:    value = signal.p[0] + (signal.p[1] - signal.p[0]) * std::fmod(seconds, signal.p[2]) / signal.p[2]; break;
+            case Pattern::SINE:    value = signal.p[0] + signal.p[1] * std::sin(2 * pi * seconds / signal.p[2]); break;
+            case Pattern::COUNTER: value = std::floor(signal.p[0] * seconds); break;
+            case Pattern::TOGGLE:  value = static_cast<long long>(seconds / signal.p[0]) % 2; break;
+            case Pattern::RANDOM: {
+                std::lock_guard<std::mutex> lock{_randomMutex};
+                value = std::uniform_real_distribution<double>(signal.p[0], signal.p[1])(_random);
+                break;
+            }
+            case Pattern::TEXT:    break;
+        }
+        Area& area = *findArea(signal.item.Area);
+        const int index = area.srvArea == srvAreaDB ? 1 : 0;
+        if(_server) {
+            _server->LockArea(area.srvArea, index);
+        }
+        writeValue(area, signal, value);
+        if(_server) {
+            _server->UnlockArea(area.srvArea, index);
+        }
+    }
+}
+
+// Values are stored like in the PLC: big endian
+void RAMS7200Simulator::writeValue(Area& area, const Signal& signal, double value)
+{
+    const auto& item = signal.item;
+    const size_t start = item.WordLen == S7WLBit ? item.Start / 8 : item.Start;
+    const size_t size = Common::S7Utils::DataSizeByte(item.WordLen) * item.Amount;
+    if(start + size > area.data.size()) {
+        return; // outside of the area, reads of it fail as on a real PLC
+    }
+    uint8_t* p = area.data.data() + start;
+    switch(item.WordLen) {
+        case S7WLBit: {
+            const uint8_t mask = 1 << (item.Start % 8);
+            *p = value != 0 ? (*p | mask) : (*p & ~mask);
+            break;
+        }
+        case S7WLByte:
+            if(signal.pattern == Pattern::TEXT) {
+                memset(p, 0, size);
+                memcpy(p, signal.text.data(), std::min(size, signal.text.size()));
+            } else {
+                memset(p, static_cast<uint8_t>(static_cast<long long>(value)), size);
+            }
+            break;
+        case S7WLWord: {
+            const uint16_t v = static_cast<uint16_t>(static_cast<long long>(value));
+            p[0] = v >> 8;
+            p[1] = v & 0xFF;
+            break;
+        }
+        default: { // S7WLReal
+            const float f = static_cast<float>(value);
+            const float swapped = Common::Utils::CopyNSwapBytes<float>(f);
+            memcpy(p, &swapped, sizeof(float));
+            break;
+        }
+    }
+}
+
+void S7API RAMS7200Simulator::onEvent(void* usrPtr, PSrvEvent event, int)
+{
+    auto self = static_cast<RAMS7200Simulator*>(usrPtr);
+    if(event->EvtCode == evcDataRead) {
+        ++self->_reads;
+    } else if(event->EvtCode == evcDataWrite) {
+        ++self->_writes;
+    } else {
+        return;
+    }
+    self->delayEvent();
+}
+
+// snap7 raises the data events from the worker thread serving the client: sleeping here delays the answers
+void RAMS7200Simulator::delayEvent()
+{
+    uint32_t delayMs = _config.latencyMs;
+    {
+        std::lock_guard<std::mutex> lock{_randomMutex};
+        if(_config.jitterMs > 0) {
+            delayMs += std::uniform_int_distribution<uint32_t>(0, _config.jitterMs)(_random);
+        }
+        if(_config.failRate > 0 && std::uniform_real_distribution<double>(0, 1)(_random) < _config.failRate) {
+            delayMs = _config.failDelayMs;
+            ++_failures;
+        }
+    }
+    if(delayMs > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+    }
+}
@@ -0,0 +1,122 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "snap7.h"
+
+/**
+ * @brief Simulated S7-200 for tests and benchmarks: a snap7 TS7Server exposing the V (DB1), M, I
+ * and Q areas addressed by the driver, with scripted value changes, latency and failures.
+ *
+ * Script lines (# starts a comment), addresses use the driver syntax:
+ *   area  <V|M|I|Q> <bytes>                       size of an area (default V 65535, others 256)
+ *   <address> const   <value>
+ *   <address> ramp    <from> <to> <period s>
+ *   <address> sine    <offset> <amplitude> <period s>
+ *   <address> counter <step per second>
+ *   <address> toggle  <period s>
+ *   <address> random  <min> <max>
+ *   <address> text    <string>                    VBx.n only
+ * Scripted values are refreshed every tick and overwrite what clients write at the same address.
+ */
+class RAMS7200Simulator
+{
+public:
+    struct Config
+    {
+        std::string address{"127.0.0.1"};
+        uint16_t port{102};
+        uint32_t tickMs{100};
+        uint32_t latencyMs{0};      // added to every data read/write event of the server
+        uint32_t jitterMs{0};       // uniform random extra latency
+        double failRate{0};         // probability that a read/write is not answered in time
+        uint32_t failDelayMs{4000}; // delay of a failed read/write, over the 3 s snap7 client receive timeout
+        uint32_t dropEvery{0};      // seconds between server restarts dropping all connections, 0: never
+    };
+
+    explicit RAMS7200Simulator(Config config);
+    RAMS7200Simulator(const RAMS7200Simulator&) = delete;
+    RAMS7200Simulator& operator=(const RAMS7200Simulator&) = delete;
+    ~RAMS7200Simulator();
+
+    /**
+     * @brief Adds the lines of a script file, call before start()
+     * @return false (and prints the faulty line) if a line cannot be parsed
+     */
+    bool loadScript(const std::string& path);
+    bool addLine(const std::string& line);
+
+    /**
+     * @return snap7 error code of the server start, 0 when listening
+     */
+    int start();
+    void stop();
+
+    uint64_t getReads() const {return _reads.load();}
+    uint64_t getWrites() const {return _writes.load();}
+    uint64_t getFailures() const {return _failures.load();}
+    uint64_t getDrops() const {return _drops.load();}
+
+private:
+    enum class Pattern {CONST, RAMP, SINE, COUNTER, TOGGLE, RANDOM, TEXT};
+
+    struct Signal
+    {
+        TS7DataItem item;
+        Pattern pattern;
+        double p[3];
+        std::string text;
+    };
+
+    struct Area
+    {
+        int srvArea;    // snap7 server area code
+        int s7Area;     // area code of the driver addresses
+        std::vector<uint8_t> data;
+    };
+
+    static void S7API onEvent(void* usrPtr, PSrvEvent event, int size);
+    void delayEvent();
+    void tick(double seconds);
+    void writeValue(Area& area, const Signal& signal, double value);
+    Area* findArea(int s7Area);
+    void run();
+
+    Config _config;
+    std::vector<Area> _areas;
+    std::vector<Signal> _signals;
+    std::unique_ptr<TS7Server> _server;
+
+    std::mt19937 _random{7200};
+    std::mutex _randomMutex;
+
+    std::atomic<uint64_t> _reads{0};
+    std::atomic<uint64_t> _writes{0};
+    std::atomic<uint64_t> _failures{0};
+    std::atomic<uint64_t> _drops{0};
+
+    std::thread _thread;
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    bool _run{false};
+};
@@ -0,0 +1,405 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Load test of the acquisition: N simulated PLCs (one per loopback address 127.0.x.y) with M tags
+// each, polled by the driver code (RAMS7200LibFacade::Run, one thread per PLC as in
+// RAMS7200HWService) into the delivery queue, drained by a workProc thread where toDp is a stub.
+// Every combination of the PLC and tag counts is one stage; a line per stage reports the achieved
+// poll cycles/s, values/s, driver CPU per value (PLC threads and workProc only, the simulators are
+// excluded), process memory and the cycle overruns.
+
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RAMS7200DeliveryQueue.hxx"
+#include "RAMS7200LibFacade.hxx"
+#include "RAMS7200MS.hxx"
+#include "RAMS7200Simulator.hxx"
+#include "Common/Constants.hxx"
+#include "Common/LatencyHistogram.hxx"
+#include "Common/Logger.hxx"
+
+using clock_type = std::chrono::steady_clock;
+
+struct Options
+{
+    std::vector<uint32_t> plcCounts{1, 10};
+    std::vector<uint32_t> tagCounts{100, 1000};
+    std::vector<std::pair<std::string, uint32_t>> sizeMix{{"D", 4}, {"W", 2}, {"B", 1}, {"X", 1}};
+    std::vector<std::pair<uint32_t, uint32_t>> pollMix{{1, 1}};
+    uint32_t pollingInterval{1};
+    uint16_t port{10102};
+    uint32_t latencyMs{0};
+    uint32_t jitterMs{0};
+    double failRate{0};
+    uint32_t stageSeconds{10};
+    uint32_t workProcMs{10};
+    size_t queueCapacity{0};
+    RAMS7200DeliveryQueue::Overflow overflow{RAMS7200DeliveryQueue::Overflow::DROP_OLDEST};
+    bool json{false};
+};
+
+struct StageResult
+{
+    uint32_t plcs;
+    uint32_t tags;
+    double seconds;
+    uint64_t cycles;
+    uint64_t requests;
+    uint64_t values;
+    uint64_t internalValues;
+    uint64_t overruns;
+    uint64_t readErrors;
+    double cycleMaxMs;
+    double cpuSeconds;
+    double rssMb;
+    double s7RttP99Ms;
+    double deliveryP99Ms;
+    uint64_t dropped;
+    uint64_t spilled;
+};
+
+static double threadCpuSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double rssMb()
+{
+    long pages = 0, resident = 0;
+    FILE* f = fopen("/proc/self/statm", "r");
+    if(f) {
+        if(fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+            resident = 0;
+        }
+        fclose(f);
+    }
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024 * 1024);
+}
+
+// Picks the entries of a weighted mix in a fixed, evenly spread order
+template <typename T>
+static const T& pick(const std::vector<std::pair<T, uint32_t>>& mix, size_t index)
+{
+    uint32_t total = 0;
+    for(const auto& entry : mix) {
+        total += entry.second;
+    }
+    uint32_t slot = static_cast<uint32_t>((index * 7919) % total);
+    for(const auto& entry : mix) {
+        if(slot < entry.second) {
+            return entry.first;
+        }
+        slot -= entry.second;
+    }
+    return mix.back().first;
+}
+
+class RAMS7200LoadGenerator
+{
+public:
+    explicit RAMS7200LoadGenerator(const Options& options) : _options(options) {}
+
+    bool runStage(uint32_t plcs, uint32_t tags, StageResult& result)
+    {
+        // Same tags on every PLC, packed in V memory
+        std::vector<std::pair<std::string, uint32_t>> tagList;
+        uint32_t offset = 0;
+        for(uint32_t i = 0; i < tags; i++) {
+            const std::string& size = pick(_options.sizeMix, i);
+            std::string address;
+            switch(size[0]) {
+                case 'X': address = "V" + std::to_string(offset) + ".0"; offset += 1; break;
+                case 'B': address = "VB" + std::to_string(offset); offset += 1; break;
+                case 'W': address = "VW" + std::to_string(offset); offset += 2; break;
+                case 'D': address = "VD" + std::to_string(offset); offset += 4; break;
+                default: { // S<n>
+                    const uint32_t length = static_cast<uint32_t>(atoi(size.c_str() + 1));
+                    address = "VB" + std::to_string(offset) + "." + std::to_string(length);
+                    offset += length;
+                }
+            }
+            tagList.emplace_back(address, pick(_options.pollMix, i));
+        }
+        if(offset > 65535) {
+            fprintf(stderr, "%u tags need %u bytes of V memory, more than 65535\n", tags, offset);
+            return false;
+        }
+
+        std::vector<std::unique_ptr<RAMS7200Simulator>> simulators;
+        std::vector<std::unique_ptr<RAMS7200MS>> MSs;
+        for(uint32_t i = 0; i < plcs; i++) {
+            RAMS7200Simulator::Config config;
+            config.address = "127.0." + std::to_string(1 + i / 250) + "." + std::to_string(1 + i % 250);
+            config.port = _options.port;
+            config.tickMs = 1000;
+            config.latencyMs = _options.latencyMs;
+            config.jitterMs = _options.jitterMs;
+            config.failRate = _options.failRate;
+            simulators.emplace_back(new RAMS7200Simulator(config));
+            simulators.back()->addLine("area V " + std::to_string(std::max<uint32_t>(offset, 1)));
+            const int error = simulators.back()->start();
+            if(error != 0) {
+                fprintf(stderr, "Cannot start the simulated PLC %s:%u: %s\n", config.address.c_str(), config.port, SrvErrorText(error).c_str());
+                return false;
+            }
+            MSs.emplace_back(new RAMS7200MS(config.address));
+            for(const auto& tag : tagList) {
+                MSs.back()->addVar(tag.first, tag.second);
+            }
+        }
+
+        RAMS7200DeliveryQueue queue;
+        queue.configure(_options.queueCapacity, _options.overflow, "/tmp/RAMS7200_loadgen_journal.bin");
+        // RAMS7200HWService::queueToDP
+        queueToDPCallback queueToDPCB = [&queue](const std::string& dp_address, uint16_t length, char* payload) {
+            queue.push(dp_address.c_str(), length, payload);
+        };
+        queueBatchToDPCallback queueBatchToDPCB = [&queue](toDPBatch& batch) {
+            queue.push(batch);
+        };
+
+        const auto s7RttBefore = RAMS7200Stats::globalLatencies().s7Rtt.snapshot();
+        const double rssBefore = rssMb();
+        const auto start = clock_type::now();
+        std::atomic<bool> driverRun{true};
+        std::vector<double> plcCpu(plcs, 0.0);
+        std::vector<std::thread> plcThreads;
+        for(uint32_t i = 0; i < plcs; i++) {
+            MSs[i]->_run = true;
+            plcThreads.emplace_back([&, i]() {
+                RAMS7200LibFacade facade(*MSs[i], queueToDPCB, queueBatchToDPCB);
+                facade.Run(driverRun);
+                plcCpu[i] = threadCpuSeconds();
+            });
+        }
+
+        // workProc, the DrvManager calls it between the dispatch of messages
+        Common::LatencyHistogram delivery;
+        uint64_t values = 0, internalValues = 0;
+        double workProcCpu = 0;
+        std::atomic<bool> workProcRun{true};
+        std::thread workProc([&]() {
+            auto deliver = [&](toDPEntry& item, std::chrono::steady_clock::time_point) {
+                // toDp stub: the DPE lookup and the message to the event manager are not measured.
+                // Measured from the acquisition time that workProc gives toDp
+                delivery.record(std::chrono::system_clock::now() - std::get<4>(item));
+                const char* address = std::get<0>(item);
+                if(strstr(address, "$_")) {
+                    ++internalValues;
+                } else {
+                    ++values;
+                }
+                delete[] std::get<2>(item);
+            };
+            while(workProcRun) {
+                queue.drain(deliver);
+                std::this_thread::sleep_for(std::chrono::milliseconds(_options.workProcMs));
+            }
+            queue.drain(deliver);
+            workProcCpu = threadCpuSeconds();
+        });
+
+        std::this_thread::sleep_for(std::chrono::seconds(_options.stageSeconds));
+        result.rssMb = rssMb();
+        driverRun = false;
+        for(auto& ms : MSs) {
+            ms->_run = false;
+            ms->_threadCv.notify_all();
+        }
+        for(auto& thread : plcThreads) {
+            thread.join();
+        }
+        const auto end = clock_type::now();
+        workProcRun = false;
+        workProc.join();
+        for(auto& simulator : simulators) {
+            simulator->stop();
+        }
+
+        result.plcs = plcs;
+        result.tags = tags;
+        result.seconds = std::chrono::duration<double>(end - start).count();
+        result.cycles = result.requests = result.overruns = result.readErrors = 0;
+        result.cycleMaxMs = 0;
+        for(const auto& ms : MSs) {
+            result.cycles += ms->_stats.cycles();
+            result.requests += ms->_stats.requests();
+            result.overruns += ms->_stats.overruns();
+            result.readErrors += ms->_stats.readErrors();
+            result.cycleMaxMs = std::max(result.cycleMaxMs, std::chrono::duration<double, std::milli>(ms->_stats.cycleMax()).count());
+        }
+        result.values = values;
+        result.internalValues = internalValues;
+        result.cpuSeconds = workProcCpu;
+        for(double cpu : plcCpu) {
+            result.cpuSeconds += cpu;
+        }
+        result.rssMb -= rssBefore;
+        result.s7RttP99Ms = (RAMS7200Stats::globalLatencies().s7Rtt.snapshot() - s7RttBefore).percentileMs(99);
+        result.deliveryP99Ms = delivery.snapshot().percentileMs(99);
+        const auto counters = queue.counters();
+        result.dropped = counters.dropped;
+        result.spilled = counters.spilled;
+        return true;
+    }
+
+private:
+    const Options& _options;
+};
+
+template <typename T>
+static bool parseList(const char* text, std::vector<T>& list)
+{
+    list.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        const long value = atol(item.c_str());
+        if(value <= 0) {
+            return false;
+        }
+        list.push_back(static_cast<T>(value));
+    }
+    return !list.empty();
+}
+
+// <key>:<weight>,...
+template <typename Key, typename Parse>
+static bool parseMix(const char* text, std::vector<std::pair<Key, uint32_t>>& mix, Parse parse)
+{
+    mix.clear();
+    std::stringstream ss(text);
+    std::string item;
+    while(std::getline(ss, item, ',')) {
+        const auto colon = item.find(':');
+        const long weight = colon == std::string::npos ? 1 : atol(item.c_str() + colon + 1);
+        Key key;
+        if(weight <= 0 || !parse(item.substr(0, colon), key)) {
+            return false;
+        }
+        mix.emplace_back(key, static_cast<uint32_t>(weight));
+    }
+    return !mix.empty();
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -n <list>   numbers of PLCs, one stage per PLC and tag count (default 1,10)\n"
+        "  -m <list>   numbers of tags per PLC (default 100,1000)\n"
+        "  -s <mix>    tag sizes X (bit), B, W, D or S<n> (string of n bytes) with weights (default D:4,W:2,B:1,X:1)\n"
+        "  -P <mix>    poll times in seconds with weights (default 1:1)\n"
+        "  -i <s>      driver polling interval (default 1)\n"
+        "  -p <port>   port of the simulated PLCs (default 10102)\n"
+        "  -l <ms>     latency of the simulated PLCs\n"
+        "  -j <ms>     uniform random extra latency\n"
+        "  -f <rate>   probability that a read is not answered before the client timeout\n"
+        "  -t <s>      duration of a stage (default 10)\n"
+        "  -W <ms>     workProc period (default 10)\n"
+        "  -Q <n>      delivery queue capacity (default 0: unbounded)\n"
+        "  -O <policy> delivery queue overflow: dropOldest, keepLatest or journal (default dropOldest)\n"
+        "  -J          one JSON object per stage instead of the table\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    const auto parseSize = [](const std::string& text, std::string& size) {
+        size = text;
+        return text == "X" || text == "B" || text == "W" || text == "D" || (text.size() > 1 && text[0] == 'S' && atoi(text.c_str() + 1) > 0);
+    };
+    const auto parsePoll = [](const std::string& text, uint32_t& seconds) {
+        seconds = static_cast<uint32_t>(atol(text.c_str()));
+        return seconds > 0;
+    };
+    int opt;
+    bool ok = true;
+    while(ok && (opt = getopt(argc, argv, "n:m:s:P:i:p:l:j:f:t:W:Q:O:Jh")) != -1) {
+        switch(opt) {
+            case 'n': ok = parseList(optarg, options.plcCounts); break;
+            case 'm': ok = parseList(optarg, options.tagCounts); break;
+            case 's': ok = parseMix(optarg, options.sizeMix, parseSize); break;
+            case 'P': ok = parseMix(optarg, options.pollMix, parsePoll); break;
+            case 'i': options.pollingInterval = strtoul(optarg, nullptr, 10); break;
+            case 'p': options.port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 'l': options.latencyMs = strtoul(optarg, nullptr, 10); break;
+            case 'j': options.jitterMs = strtoul(optarg, nullptr, 10); break;
+            case 'f': options.failRate = atof(optarg); break;
+            case 't': options.stageSeconds = strtoul(optarg, nullptr, 10); break;
+            case 'W': options.workProcMs = strtoul(optarg, nullptr, 10); break;
+            case 'Q': options.queueCapacity = strtoul(optarg, nullptr, 10); break;
+            case 'O': options.overflow = RAMS7200DeliveryQueue::overflowFromName(optarg); break;
+            case 'J': options.json = true; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(!ok) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Driver configuration, as read by RAMS7200Resources
+    Common::Logger::setLogLvl(0);
+    Common::Constants::setPlcPort(options.port);
+    Common::Constants::setPollingInterval(options.pollingInterval);
+
+    if(!options.json) {
+        printf("%5s %6s %9s %10s %11s %11s %8s %9s %11s %8s %9s %10s\n", "PLCs", "tags", "polls/s", "requests/s", "values/s",
+            "CPU us/val", "CPU %", "RSS MB", "overruns %", "max ms", "rtt p99", "deliv p99");
+        fflush(stdout);
+    }
+    RAMS7200LoadGenerator generator(options);
+    for(uint32_t plcs : options.plcCounts) {
+        for(uint32_t tags : options.tagCounts) {
+            StageResult r;
+            if(!generator.runStage(plcs, tags, r)) {
+                return EXIT_FAILURE;
+            }
+            const double cpuPerValueUs = r.values ? r.cpuSeconds * 1e6 / r.values : 0.0;
+            const double cpuPercent = 100.0 * r.cpuSeconds / r.seconds;
+            const double overrunPercent = r.cycles ? 100.0 * r.overruns / r.cycles : 0.0;
+            if(options.json) {
+                printf("{\"plcs\": %u, \"tags\": %u, \"seconds\": %.3f, \"polls_per_s\": %.2f, \"requests_per_s\": %.2f, "
+                       "\"values_per_s\": %.1f, \"internal_values\": %llu, \"cpu_us_per_value\": %.3f, \"cpu_percent\": %.2f, "
+                       "\"rss_mb\": %.2f, \"overrun_percent\": %.2f, \"cycle_max_ms\": %.3f, \"read_errors\": %llu, "
+                       "\"s7_rtt_p99_ms\": %.3f, \"delivery_p99_ms\": %.3f, \"dropped\": %llu, \"spilled\": %llu}\n",
+                       r.plcs, r.tags, r.seconds, r.cycles / r.seconds, r.requests / r.seconds, r.values / r.seconds,
+                       static_cast<unsigned long long>(r.internalValues), cpuPerValueUs, cpuPercent, r.rssMb, overrunPercent,
+                       r.cycleMaxMs, static_cast<unsigned long long>(r.readErrors), r.s7RttP99Ms, r.deliveryP99Ms,
+                       static_cast<unsigned long long>(r.dropped), static_cast<unsigned long long>(r.spilled));
+            } else {
+                printf("%5u %6u %9.1f %10.1f %11.0f %11.2f %8.1f %9.1f %11.2f %8.1f %9.2f %10.2f\n", r.plcs, r.tags,
+                    r.cycles / r.seconds, r.requests / r.seconds, r.values / r.seconds, cpuPerValueUs, cpuPercent, r.rssMb,
+                    overrunPercent, r.cycleMaxMs, r.s7RttP99Ms, r.deliveryP99Ms);
+            }
+            fflush(stdout);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Simulated RAMS7200 PLC to poll the driver against over loopback, see RAMS7200Simulator.hxx
+// for the script syntax. Prints the served reads/writes every 10 seconds.
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+#include "RAMS7200Simulator.hxx"
+
+static volatile sig_atomic_t running = 1;
+
+static void onSignal(int)
+{
+    running = 0;
+}
+
+static void usage(const char* name)
+{
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  -a <ip>      listening address (default 127.0.0.1, any 127.x.y.z works for several PLCs)\n"
+        "  -p <port>    listening port (default 102, needs root; set plcPort in the driver config)\n"
+        "  -s <script>  area sizes and scripted values\n"
+        "  -T <ms>      script tick (default 100)\n"
+        "  -l <ms>      latency added to every read/write\n"
+        "  -j <ms>      uniform random extra latency\n"
+        "  -f <rate>    probability that a read/write is not answered before the client timeout\n"
+        "  -d <s>       restart the server every <s> seconds, dropping all connections\n"
+        "  -t <s>       stop after <s> seconds (default: run until SIGINT/SIGTERM)\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    RAMS7200Simulator::Config config;
+    const char* script = nullptr;
+    long duration = 0;
+    int opt;
+    while((opt = getopt(argc, argv, "a:p:s:T:l:j:f:d:t:h")) != -1) {
+        switch(opt) {
+            case 'a': config.address = optarg; break;
+            case 'p': config.port = static_cast<uint16_t>(atoi(optarg)); break;
+            case 's': script = optarg; break;
+            case 'T': config.tickMs = strtoul(optarg, nullptr, 10); break;
+            case 'l': config.latencyMs = strtoul(optarg, nullptr, 10); break;
+            case 'j': config.jitterMs = strtoul(optarg, nullptr, 10); break;
+            case 'f': config.failRate = atof(optarg); break;
+            case 'd': config.dropEvery = strtoul(optarg, nullptr, 10); break;
+            case 't': duration = atol(optarg); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if(config.tickMs == 0) {
+        config.tickMs = 1;
+    }
+
+    RAMS7200Simulator simulator(config);
+    if(script && !simulator.loadScript(script)) {
+        return EXIT_FAILURE;
+    }
+    const int result = simulator.start();
+    if(result != 0) {
+        fprintf(stderr, "Cannot start the server on %s:%u: %s\n", config.address.c_str(), config.port, SrvErrorText(result).c_str());
+        return EXIT_FAILURE;
+    }
+    printf("Simulating a PLC on %s:%u\n", config.address.c_str(), config.port);
+    fflush(stdout);
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    uint64_t reads = 0, writes = 0;
+    for(long elapsed = 1; running && (duration == 0 || elapsed <= duration); elapsed++) {
+        sleep(1);
+        if(elapsed % 10 == 0) {
+            printf("reads/s %.1f writes/s %.1f failures %llu drops %llu\n", (simulator.getReads() - reads) / 10.0,
+                (simulator.getWrites() - writes) / 10.0, static_cast<unsigned long long>(simulator.getFailures()),
+                static_cast<unsigned long long>(simulator.getDrops()));
+            fflush(stdout);
+            reads = simulator.getReads();
+            writes = simulator.getWrites();
+        }
+    }
+    simulator.stop();
+    printf("Served %llu reads and %llu writes\n", static_cast<unsigned long long>(simulator.getReads()), static_cast<unsigned long long>(simulator.getWrites()));
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#include <cstring>
+
+#include "RAMS7200BurstTrans.hxx"
+
+#include "RAMS7200HWMapper.hxx"
+
+#include "Common/Utils.hxx"
+
+#include <BitVar.hxx>
+#include <DynVar.hxx>
+#include <FloatVar.hxx>
+#include <IntegerVar.hxx>
+#include <TimeVar.hxx>
+
+namespace Transformations{
+
+TransformationType RAMS7200BurstTrans::isA() const {
+    return (TransformationType) RAMS7200DrvBurstTransType;
+}
+
+TransformationType RAMS7200BurstTrans::isA(TransformationType type) const {
+	if (type == isA())
+		return type;
+	else
+		return Transformation::isA(type);
+}
+
+Transformation *RAMS7200BurstTrans::clone() const {
+	return new RAMS7200BurstTrans;
+}
+
+int RAMS7200BurstTrans::itemSize() const {
+	return 1;
+}
+
+VariableType RAMS7200BurstTrans::getVariableType() const {
+	return DYNFLOAT_VAR;
+}
+
+PVSSboolean RAMS7200BurstTrans::toPeriph(PVSSchar *buffer, PVSSuint len, const Variable &var, const PVSSuint subix) const {
+	ErrHdl::error(ErrClass::PRIO_SEVERE, // Data will be lost
+			ErrClass::ERR_PARAM, // Wrong parametrization
+			ErrClass::UNEXPECTEDSTATE, // Nothing else appropriate
+			"RAMS7200BurstTrans", "toPeriph", // File and function name
+			"Burst samples cannot be written" // Unfortunately we don't know which DP
+			);
+	return PVSS_FALSE;
+}
+
+VariablePtr RAMS7200BurstTrans::toVar(const PVSSchar *buffer, const PVSSuint dlen, const PVSSuint subix) const {
+
+	if(buffer == NULL || dlen < 1){
+		ErrHdl::error(ErrClass::PRIO_SEVERE, // Data will be lost
+				ErrClass::ERR_PARAM, // Wrong parametrization
+				ErrClass::UNEXPECTEDSTATE, // Nothing else appropriate
+				"RAMS7200BurstTrans", "toVar", // File and function name
+				"Null buffer pointer or wrong length: " + CharString(dlen) // Unfortunately we don't know which DP
+				);
+		return NULL;
+	}
+
+	const char* samples = reinterpret_cast<const char*>(buffer + 1);
+	const PVSSuint length = dlen - 1;
+	DynVar* dyn = nullptr;
+	switch(buffer[0]) {
+		case 'X':
+			dyn = new DynVar(BIT_VAR);
+			for(PVSSuint i = 0; i < length; i++) {
+				dyn->append(BitVar(samples[i] != 0));
+			}
+			break;
+		case 'B':
+			dyn = new DynVar(INTEGER_VAR);
+			for(PVSSuint i = 0; i < length; i++) {
+				dyn->append(IntegerVar((int32_t)*reinterpret_cast<const uint8_t*>(samples + i)));
+			}
+			break;
+		case 'W':
+			dyn = new DynVar(INTEGER_VAR);
+			for(PVSSuint i = 0; i + sizeof(int16_t) <= length; i += sizeof(int16_t)) {
+				dyn->append(IntegerVar(Common::Utils::CopyNSwapBytes<int16_t>(samples + i)));
+			}
+			break;
+		case 'D':
+			dyn = new DynVar(FLOAT_VAR);
+			for(PVSSuint i = 0; i + sizeof(float) <= length; i += sizeof(float)) {
+				dyn->append(FloatVar(Common::Utils::CopyNSwapBytes<float>(samples + i)));
+			}
+			break;
+		case 'T':
+			dyn = new DynVar(TIME_VAR);
+			for(PVSSuint i = 0; i + sizeof(int64_t) <= length; i += sizeof(int64_t)) {
+				int64_t ms;
+				std::memcpy(&ms, samples + i, sizeof(int64_t));
+				dyn->append(TimeVar(ms / 1000, ms % 1000));
+			}
+			break;
+		default:
+			ErrHdl::error(ErrClass::PRIO_SEVERE, // Data will be lost
+					ErrClass::ERR_PARAM, // Wrong parametrization
+					ErrClass::UNEXPECTEDSTATE, // Nothing else appropriate
+					"RAMS7200BurstTrans", "toVar", // File and function name
+					"Unknown sample kind: " + CharString((int) buffer[0]) // Unfortunately we don't know which DP
+					);
+			break;
+	}
+	return dyn;
+}
+
+}//namespace
@@ -0,0 +1,75 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+#ifndef RAMS7200BURSTTRANS_HXX_
+#define RAMS7200BURSTTRANS_HXX_
+
+#include <Transformation.hxx>
+
+namespace Transformations{
+
+/*!
+ * Samples of a burst (see RAMS7200Burst) to a dyn: dyn_bool for X addresses, dyn_int for B and W,
+ * dyn_float for D and dyn_time for the sample times. Read only.
+ */
+class RAMS7200BurstTrans: public Transformation {
+	/*!
+	 *  Transformations typ
+	 *  \return transformation type
+	 */
+	TransformationType isA() const;
+	/*!
+	 *  Transformations typ comparison
+	 *  \param type object to return type
+	 *  \return transformation type
+	 */
+	TransformationType isA(TransformationType type) const;
+
+	/*!
+	 * Size of transformation buffer, the actual size is the one of each update
+	 * \return size of buffer
+	 */
+	int itemSize() const;
+
+	/*!
+	 * The type of Variable we are expecting here
+	 * \return actual variable type
+	 */
+	VariableType getVariableType() const;
+
+	/*!
+	 *  Clone of our class
+	 *  \return pointer to new object
+	 */
+	Transformation *clone() const;
+
+	/*!
+	 * Conversion from PVSS to Hardware, not supported
+	 * \return PVSS_FALSE
+	 */
+	PVSSboolean toPeriph(PVSSchar *dataPtr, PVSSuint len, const Variable &var,
+			const PVSSuint subix) const;
+
+	/*!
+	 * Conversion from Hardware to PVSS
+	 * \param data kind byte followed by the samples
+	 * \param dlen length of data buffer
+	 * \param subix subindex of value associated with peripheral address
+	 * \return the dyn of the samples, oldest first
+	 */
+	VariablePtr toVar(const PVSSchar *data, const PVSSuint dlen,
+			const PVSSuint subix) const;
+};
+
+
+}//namespace
+#endif /* RAMS7200BURSTTRANS_HXX_ */
@@ -0,0 +1,312 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Micro-benchmarks of the per value paths of the driver: address parsing, request planning of
+// RAMS7200ReadWriteMaxN, byte swapping, the transformations and the queue to workProc.
+// Every benchmark is run until it lasts --min-time seconds, 3 times; the median is reported.
+// Usage: bench [--json] [--min-time <s>] [name filter]
+// --json prints the results in the Google Benchmark format, e.g. to compare two builds with its compare.py.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <BitVar.hxx>
+#include <FloatVar.hxx>
+#include <IntegerVar.hxx>
+#include <TextVar.hxx>
+
+#include "config.h"
+#include "RAMS7200DeliveryQueue.hxx"
+#include "RAMS7200LibFacade.hxx"
+#include "Common/S7Utils.hxx"
+#include "Common/Utils.hxx"
+#include "Transformations/RAMS7200BoolTrans.hxx"
+#include "Transformations/RAMS7200FloatTrans.hxx"
+#include "Transformations/RAMS7200Int16Trans.hxx"
+#include "Transformations/RAMS7200Int32Trans.hxx"
+#include "Transformations/RAMS7200StringTrans.hxx"
+#include "Transformations/RAMS7200Uint8Trans.hxx"
+
+// Keeps the compiler from optimizing away a result
+template <typename T>
+static inline void keep(const T& value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Result {
+    std::string name;
+    uint64_t iterations;
+    double realNs;  // per operation
+    double cpuNs;
+};
+
+class Bench {
+public:
+    // body(n) runs n iterations of opsPerIteration operations each
+    using Body = std::function<void(uint64_t)>;
+
+    Bench(double minTime, const char* filter) : _minTime(minTime), _filter(filter) {}
+
+    void run(const std::string& name, uint64_t opsPerIteration, const Body& body)
+    {
+        if(_filter && name.find(_filter) == std::string::npos) {
+            return;
+        }
+        // Calibration, also warms up caches and allocator
+        uint64_t iterations = 1;
+        for(;;) {
+            const auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if(elapsed >= _minTime || iterations >= (1ULL << 40)) {
+                break;
+            }
+            iterations = elapsed < _minTime / 100 ? iterations * 10 : static_cast<uint64_t>(iterations * 1.2 * _minTime / elapsed) + 1;
+        }
+
+        std::vector<std::pair<double, double>> runs;
+        for(int repetition = 0; repetition < 3; repetition++) {
+            const double cpuStart = cpuSeconds();
+            const auto start = std::chrono::steady_clock::now();
+            body(iterations);
+            const double real = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+            const double cpu = (cpuSeconds() - cpuStart) * 1e9;
+            const double ops = static_cast<double>(iterations * opsPerIteration);
+            runs.emplace_back(real / ops, cpu / ops);
+        }
+        std::sort(runs.begin(), runs.end());
+        _results.push_back(Result{name, iterations * opsPerIteration, runs[1].first, runs[1].second});
+    }
+
+    void printTable() const
+    {
+        printf("%-44s %14s %12s %12s %14s\n", "Benchmark", "Operations", "ns/op", "CPU ns/op", "ops/s");
+        for(const auto& r : _results) {
+            printf("%-44s %14llu %12.1f %12.1f %14.0f\n", r.name.c_str(), static_cast<unsigned long long>(r.iterations),
+                r.realNs, r.cpuNs, 1e9 / r.realNs);
+        }
+    }
+
+    void printJson() const
+    {
+        char date[32];
+        const time_t t = time(nullptr);
+        struct tm tm;
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime_r(&t, &tm));
+        printf("{\n  \"context\": {\n    \"date\": \"%s\",\n    \"executable\": \"bench\",\n    \"version\": \"%s\",\n"
+               "    \"compiler\": \"%s\",\n    \"min_time\": %g,\n    \"repetitions\": 3\n  },\n  \"benchmarks\": [",
+               date, PROJECT_VER, __VERSION__, _minTime);
+        for(size_t i = 0; i < _results.size(); i++) {
+            const auto& r = _results[i];
+            printf("%s\n    {\"name\": \"%s\", \"run_type\": \"iteration\", \"iterations\": %llu, \"real_time\": %.3f, "
+                   "\"cpu_time\": %.3f, \"time_unit\": \"ns\", \"items_per_second\": %.0f}",
+                   i ? "," : "", r.name.c_str(), static_cast<unsigned long long>(r.iterations), r.realNs, r.cpuNs, 1e9 / r.realNs);
+        }
+        printf("\n  ]\n}\n");
+    }
+
+private:
+    static double cpuSeconds()
+    {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    const double _minTime;
+    const char* _filter;
+    std::vector<Result> _results;
+};
+
+// Mix of the addresses found in the projects, all of the word lengths
+static const std::vector<std::string> addresses = {
+    "VD100", "VW2", "VB9", "V0.3", "VB2000.20", "MW12", "VD4096", "E1.7", "A0.0", "M3.4", "VB44", "VW65530"
+};
+
+static void benchAddresses(Bench& bench)
+{
+    const uint64_t n = addresses.size();
+    bench.run("S7Utils/AddressIsValid", n, [](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            for(const auto& address : addresses) {
+                keep(Common::S7Utils::AddressIsValid(address));
+            }
+        }
+    });
+    bench.run("S7Utils/GetByteSizeFromAddress", n, [](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            for(const auto& address : addresses) {
+                keep(Common::S7Utils::GetByteSizeFromAddress(address));
+            }
+        }
+    });
+    bench.run("S7Utils/TS7DataItemFromAddress", n, [](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            for(const auto& address : addresses) {
+                TS7DataItem item = Common::S7Utils::TS7DataItemFromAddress(address);
+                keep(item);
+                delete[] static_cast<char*>(item.pdata);
+            }
+        }
+    });
+    // Poll and periphery addresses as configured on the DPEs: <ip_combo>$<address>$<poll time>
+    std::vector<std::string> dpAddresses;
+    for(const auto& address : addresses) {
+        dpAddresses.push_back("10.10.10.10_127.0.0.1$" + address + "$1");
+    }
+    bench.run("Utils/split", n, [&dpAddresses](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            for(const auto& address : dpAddresses) {
+                keep(Common::Utils::split(address));
+            }
+        }
+    });
+}
+
+// Request planning of RAMS7200ReadWriteMaxN for a poll of 1000 items, ns per planned item
+static void benchBatching(Bench& bench)
+{
+    std::vector<TS7DataItem> items;
+    for(size_t i = 0; i < 1000; i++) {
+        const auto& address = addresses[i % addresses.size()];
+        items.push_back(Common::S7Utils::TS7DataItemFromAddress(address));
+    }
+    struct Plan { const char* name; unsigned int maxItems; int varOverhead; int msgOverhead; };
+    // As called by RAMS7200LibFacade::Poll and WriteToPLC
+    for(const auto& plan : {Plan{"S7Utils/ItemsInRequest/read", 19, OVERHEAD_READ_VARIABLE, OVERHEAD_READ_MESSAGE},
+                            Plan{"S7Utils/ItemsInRequest/write", 10, OVERHEAD_WRITE_VARIABLE, OVERHEAD_WRITE_MESSAGE}}) {
+        bench.run(plan.name, items.size(), [&items, &plan](uint64_t iterations) {
+            for(uint64_t i = 0; i < iterations; i++) {
+                size_t lastIndex = 0;
+                int requestSize = 0;
+                while(lastIndex < items.size()) {
+                    const unsigned int toSend = Common::S7Utils::ItemsInRequest(&items[lastIndex], items.size() - lastIndex, plan.maxItems, PDU_SIZE, plan.varOverhead, plan.msgOverhead, requestSize);
+                    keep(requestSize);
+                    lastIndex += toSend > 0 ? toSend : 1;
+                }
+            }
+        });
+    }
+    for(auto& item : items) {
+        delete[] static_cast<char*>(item.pdata);
+    }
+}
+
+template <typename T>
+static void benchSwap(Bench& bench, const char* name)
+{
+    std::vector<T> values(1024);
+    for(size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<T>(i * 7);
+    }
+    bench.run(name, values.size(), [&values](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            for(auto& value : values) {
+                value = Common::Utils::CopyNSwapBytes<T>(value);
+            }
+            keep(values.front());
+        }
+    });
+}
+
+// Through the base class like the driver manager does, toVar/toPeriph are private in the subclasses
+static void benchTransformation(Bench& bench, const std::string& name, const Transformation& trans, const Variable& var, PVSSuint size)
+{
+    std::vector<PVSSchar> buffer(size, 0);
+    bench.run("Trans/" + name + "/toPeriph", 1, [&](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            keep(trans.toPeriph(buffer.data(), size, var, 0));
+        }
+    });
+    bench.run("Trans/" + name + "/toVar", 1, [&](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            VariablePtr result = trans.toVar(buffer.data(), size, 0);
+            keep(result);
+            delete result;
+        }
+    });
+}
+
+static void benchTransformations(Bench& bench)
+{
+    benchTransformation(bench, "Bool", Transformations::RAMS7200BoolTrans(), BitVar(PVSS_TRUE), 1);
+    benchTransformation(bench, "Uint8", Transformations::RAMS7200Uint8Trans(), IntegerVar(200), 1);
+    benchTransformation(bench, "Int16", Transformations::RAMS7200Int16Trans(), IntegerVar(-1234), 2);
+    benchTransformation(bench, "Int32", Transformations::RAMS7200Int32Trans(), IntegerVar(123456789), 4);
+    benchTransformation(bench, "Float", Transformations::RAMS7200FloatTrans(), FloatVar(3.14159), 4);
+    benchTransformation(bench, "String", Transformations::RAMS7200StringTrans(), TextVar("RAMS7200"), 20);
+}
+
+// Queue from the PLC threads to workProc (without the DPE lookup and toDp of workProc) for the
+// 1000 values of one poll, ns per value
+static void benchQueue(Bench& bench)
+{
+    std::vector<CharString> dpAddresses;
+    for(size_t i = 0; i < 1000; i++) {
+        dpAddresses.emplace_back(("10.10.10.10_127.0.0.1$" + addresses[i % addresses.size()]).c_str());
+    }
+    RAMS7200DeliveryQueue queue;
+    bench.run("toDPqueue/enqueue+drain", dpAddresses.size(), [&](uint64_t iterations) {
+        for(uint64_t i = 0; i < iterations; i++) {
+            for(const auto& address : dpAddresses) {
+                queue.push(CharString(address), 4, new char[4]); // queueToDP copies the address of the item
+            }
+            queue.drain([](toDPEntry& item, std::chrono::steady_clock::time_point) {
+                keep(std::get<3>(item));
+                delete[] std::get<2>(item);
+            });
+        }
+    });
+}
+
+int main(int argc, char* argv[])
+{
+    bool json = false;
+    double minTime = 0.2;
+    const char* filter = nullptr;
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--json") == 0) {
+            json = true;
+        } else if(strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTime = atof(argv[++i]);
+        } else if(argv[i][0] == '-') {
+            fprintf(stderr, "Usage: %s [--json] [--min-time <s>] [name filter]\n", argv[0]);
+            return strcmp(argv[i], "-h") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    Bench bench(minTime, filter);
+    benchAddresses(bench);
+    benchBatching(bench);
+    benchSwap<int16_t>(bench, "Utils/CopyNSwapBytes<int16_t>");
+    benchSwap<int32_t>(bench, "Utils/CopyNSwapBytes<int32_t>");
+    benchSwap<float>(bench, "Utils/CopyNSwapBytes<float>");
+    benchTransformations(bench);
+    benchQueue(bench);
+
+    if(json) {
+        bench.printJson();
+    } else {
+        bench.printTable();
+    }
+    return EXIT_SUCCESS;
+}
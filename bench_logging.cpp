@@ -0,0 +1,103 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Cost of the logging of one poll cycle: RAMS7200LibFacade::Poll of the driver against a simulated PLC,
+// at the default level 1 where the debug messages are filtered, then at level 4 where every message
+// is built and written (to /dev/null). The CPU of the polling thread is measured, not the PLC's.
+// Usage: bench_logging [items per poll] [polls] [port]   (default 100 1000 10103)
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "RAMS7200LibFacade.hxx"
+#include "RAMS7200MS.hxx"
+#include "RAMS7200Simulator.hxx"
+#include "Common/Constants.hxx"
+#include "Common/Logger.hxx"
+
+static double threadCpuSeconds()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+class RAMS7200LoggingBench
+{
+public:
+    RAMS7200LoggingBench(const std::string& ip, size_t itemCount) : _ms(ip)
+    {
+        for(size_t i = 0; i < itemCount; i++) {
+            _ms.addVar("VD" + std::to_string(4 * i), 1);
+        }
+        _ms._run = true;
+    }
+
+    // CPU ns of the polling thread per poll of every item, at the given logging level
+    double nsPerPoll(int level, size_t polls)
+    {
+        RAMS7200LibFacade facade(_ms, [](const std::string&, uint16_t, char* payload) { delete[] payload; });
+        facade.Connect();
+        // Warm up: connection, first allocations
+        facade.Poll(true);
+        Common::Logger::setLogLvl(level);
+        const double start = threadCpuSeconds();
+        for(size_t i = 0; i < polls; i++) {
+            facade.Poll(true);
+        }
+        const double cpu = threadCpuSeconds() - start;
+        Common::Logger::setLogLvl(Common::Logger::L1);
+        return cpu * 1e9 / polls;
+    }
+
+private:
+    RAMS7200MS _ms;
+};
+
+int main(int argc, char* argv[])
+{
+    const size_t itemCount = argc > 1 ? strtoul(argv[1], nullptr, 10) : 100;
+    const size_t polls = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1000;
+    const uint16_t port = static_cast<uint16_t>(argc > 3 ? strtoul(argv[3], nullptr, 10) : 10103);
+    if(itemCount == 0 || itemCount > 65535 / 4 || polls == 0) {
+        fprintf(stderr, "Usage: %s [items per poll (1-16383)] [polls] [port]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    RAMS7200Simulator::Config config;
+    config.port = port;
+    RAMS7200Simulator simulator(config);
+    simulator.addLine("area V " + std::to_string(4 * itemCount));
+    const int error = simulator.start();
+    if(error != 0) {
+        fprintf(stderr, "Cannot start the simulated PLC %s:%u: %s\n", config.address.c_str(), config.port, SrvErrorText(error).c_str());
+        return EXIT_FAILURE;
+    }
+    Common::Logger::setLogLvl(Common::Logger::L1);
+    Common::Constants::setPlcPort(port);
+
+    RAMS7200LoggingBench bench(config.address, itemCount);
+    const double filtered = bench.nsPerPoll(Common::Logger::L1, polls);
+    // The level 4 messages are written, but not to the terminal
+    if(!freopen("/dev/null", "w", stderr)) {
+        perror("/dev/null");
+        return EXIT_FAILURE;
+    }
+    const double written = bench.nsPerPoll(Common::Logger::L4, polls);
+
+    printf("Poll of %zu items, CPU of the polling thread (%zu polls)\n", itemCount, polls);
+    printf("  level 1, debug filtered : %10.0f ns\n", filtered);
+    printf("  level 4, debug written  : %10.0f ns\n", written);
+    printf("  debug logging           : %10.0f ns (%.1f%% of the level 1 poll)\n", written - filtered, 100 * (written - filtered) / filtered);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Test of the aggregation of the addresses: the min<s>, max<s> and mean<s> fields, and the windows
+// aligned on the epoch that close with the first value of the next window.
+// Usage: test_aggregate
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include "RAMS7200Aggregate.hxx"
+#include "Common/S7Utils.hxx"
+
+static int ok = 0; // Number of checks passed
+static int ko = 0; // Number of checks failed
+
+static void check(bool passed, const std::string& what)
+{
+    printf("%-70s %s\n", what.c_str(), passed ? "OK" : "FAILED");
+    passed ? ok++ : ko++;
+}
+
+static std::chrono::system_clock::time_point at(double seconds)
+{
+    return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(seconds)));
+}
+
+// Adds a value as the PLC thread would, raw in the S7 format of the address
+static bool add(RAMS7200Aggregator& aggregator, const RAMS7200Aggregation& aggregation, double value, double seconds,
+    double& result, std::chrono::system_clock::time_point& windowStart)
+{
+    char raw[sizeof(float)];
+    char closed[sizeof(float)];
+    RAMS7200Aggregator::encode(aggregation.wordLen, value, raw);
+    if(!aggregator.add(aggregation, raw, at(seconds), closed, windowStart)) {
+        return false;
+    }
+    result = RAMS7200Aggregator::decode(aggregation.wordLen, closed);
+    return true;
+}
+
+int main()
+{
+    RAMS7200Aggregation aggregation;
+    check(RAMS7200Aggregation::parse("mean60", aggregation) && aggregation.function == RAMS7200Aggregation::Function::MEAN
+        && aggregation.period == 60 && aggregation.field == "mean60", "mean60 parsed");
+    check(RAMS7200Aggregation::parse("min1", aggregation) && aggregation.function == RAMS7200Aggregation::Function::MIN
+        && aggregation.period == 1, "min1 parsed");
+    check(RAMS7200Aggregation::parse("max3600", aggregation) && aggregation.function == RAMS7200Aggregation::Function::MAX
+        && aggregation.period == 3600, "max3600 parsed");
+    bool refused = true;
+    for(const char* field : {"", "mean", "mean0", "mean6x", "mean-1", "mean+5", "avg60", "db60", "Mean60", "max 60"}) {
+        refused = !RAMS7200Aggregation::parse(field, aggregation) && refused;
+    }
+    check(refused, "Fields without a function or a positive period refused");
+
+    // The mean of a bit or an integer is not a value of its type
+    RAMS7200Aggregation::parse("mean60", aggregation);
+    check(aggregation.supports(S7WLReal) && !aggregation.supports(S7WLWord) && !aggregation.supports(S7WLByte)
+        && !aggregation.supports(S7WLBit), "Mean of REAL addresses only");
+    RAMS7200Aggregation::parse("max60", aggregation);
+    check(aggregation.supports(S7WLReal) && aggregation.supports(S7WLWord) && aggregation.supports(S7WLBit), "Max of any address");
+
+    // Windows aligned on the epoch: 60 s windows are minutes, whatever the time of the first value
+    {
+        RAMS7200Aggregation::parse("max60", aggregation);
+        aggregation.wordLen = S7WLWord;
+        RAMS7200Aggregator aggregator;
+        std::chrono::system_clock::time_point windowStart;
+        double result = 0;
+        bool open = !add(aggregator, aggregation, 5, 130, result, windowStart)
+            && !add(aggregator, aggregation, -7, 150.5, result, windowStart)
+            && !add(aggregator, aggregation, 300, 179.999, result, windowStart)
+            && !add(aggregator, aggregation, 2, 120, result, windowStart);
+        check(open, "Values of one minute kept in the window");
+        check(add(aggregator, aggregation, 1, 180, result, windowStart) && result == 300 && windowStart == at(120),
+            "Window closed by the next minute, timestamped at its start");
+        // Minutes without values are not delivered
+        check(add(aggregator, aggregation, 4, 425, result, windowStart) && result == 1 && windowStart == at(180),
+            "Window closed after a gap of minutes");
+    }
+    {
+        RAMS7200Aggregation::parse("min3600", aggregation);
+        aggregation.wordLen = S7WLWord;
+        RAMS7200Aggregator aggregator;
+        std::chrono::system_clock::time_point windowStart;
+        double result = 0;
+        add(aggregator, aggregation, -3, 7300, result, windowStart);
+        add(aggregator, aggregation, -9, 10799, result, windowStart);
+        check(add(aggregator, aggregation, 0, 10800, result, windowStart) && result == -9 && windowStart == at(7200),
+            "Hourly window aligned on the hour");
+    }
+    {
+        RAMS7200Aggregation::parse("mean10", aggregation);
+        aggregation.wordLen = S7WLReal;
+        RAMS7200Aggregator aggregator;
+        std::chrono::system_clock::time_point windowStart;
+        double result = 0;
+        add(aggregator, aggregation, 1, 20, result, windowStart);
+        add(aggregator, aggregation, 2, 21, result, windowStart);
+        add(aggregator, aggregation, 4.5, 29, result, windowStart);
+        check(add(aggregator, aggregation, 100, 30, result, windowStart) && std::fabs(result - 2.5) < 1e-6 && windowStart == at(20),
+            "Mean of a REAL window");
+        // The sum starts again with the new window
+        check(add(aggregator, aggregation, 0, 40, result, windowStart) && std::fabs(result - 100) < 1e-6 && windowStart == at(30),
+            "Mean of the next window alone");
+    }
+
+    printf("\n%d checks passed, %d failed\n", ok, ko);
+    return ko == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
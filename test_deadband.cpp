@@ -0,0 +1,121 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Test of the deadband of the filtered addresses: the db<amount>[%][h<hysteresis>] fields, absolute
+// and relative bands, relative bands around 0 and the hysteresis when a change reverses.
+// Usage: test_deadband
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <string>
+#include "RAMS7200Deadband.hxx"
+
+static int ok = 0; // Number of checks passed
+static int ko = 0; // Number of checks failed
+
+static void check(bool passed, const std::string& what)
+{
+    printf("%-70s %s\n", what.c_str(), passed ? "OK" : "FAILED");
+    passed ? ok++ : ko++;
+}
+
+static RAMS7200Deadband parsed(const std::string& field)
+{
+    RAMS7200Deadband deadband;
+    if(!RAMS7200Deadband::parse(field, deadband)) {
+        printf("Cannot parse %s\n", field.c_str());
+        exit(EXIT_FAILURE);
+    }
+    return deadband;
+}
+
+int main()
+{
+    RAMS7200Deadband deadband;
+    check(RAMS7200Deadband::parse("db0.5", deadband) && deadband.amount == 0.5 && !deadband.relative && deadband.hysteresis == 0
+        && deadband.field == "db0.5", "db0.5 parsed");
+    check(RAMS7200Deadband::parse("db5%", deadband) && deadband.amount == 5 && deadband.relative && deadband.hysteresis == 0,
+        "db5% parsed");
+    check(RAMS7200Deadband::parse("db0.5h0.2", deadband) && deadband.amount == 0.5 && !deadband.relative && deadband.hysteresis == 0.2,
+        "db0.5h0.2 parsed");
+    check(RAMS7200Deadband::parse("db2%h1", deadband) && deadband.amount == 2 && deadband.relative && deadband.hysteresis == 1,
+        "db2%h1 parsed");
+    check(RAMS7200Deadband::parse("db0", deadband) && deadband.amount == 0, "db0 parsed");
+    bool refused = true;
+    for(const char* field : {"", "db", "db-1", "dbx", "dbnan", "db1h", "db1h-1", "db1%%", "db1 ", "db1h0.2x", "db1x", "mean60"}) {
+        refused = !RAMS7200Deadband::parse(field, deadband) && refused;
+    }
+    check(refused, "Fields with a missing or negative amount or trailing text refused");
+
+    // Absolute band: more than the amount is delivered
+    {
+        const auto band = parsed("db0.5");
+        int direction = 0;
+        check(!band.passes(10, 10.5, direction) && !band.passes(10, 9.5, direction) && !band.passes(10, 10, direction)
+            && direction == 0, "Changes within the band dropped");
+        check(band.passes(10, 10.6, direction) && direction == 1 && band.passes(10, 9.4, direction) && direction == -1,
+            "Changes beyond the band delivered, direction updated");
+    }
+    {
+        const auto band = parsed("db0");
+        int direction = 0;
+        check(band.passes(10, 10.001, direction) && !band.passes(10, 10, direction), "db0 delivers every change");
+    }
+
+    // Relative band: in percent of the last delivered value, whatever its sign
+    {
+        const auto band = parsed("db10%");
+        int direction = 0;
+        check(!band.passes(100, 110, direction) && band.passes(100, 111, direction), "10% of 100");
+        check(!band.passes(-100, -109, direction) && band.passes(-100, -111, direction) && direction == -1, "10% of -100");
+        // Around 0 the band vanishes: the first value away from 0 is delivered
+        check(!band.passes(0, 0, direction) && band.passes(0, 1e-9, direction) && band.passes(0, -1e-9, direction),
+            "10% of 0 delivers every change");
+        check(band.passes(1e-9, 0, direction) && !band.passes(1e-9, 1.05e-9, direction), "10% of a tiny value is tiny");
+    }
+
+    // Hysteresis: a reversal needs amount + hysteresis, a change in the same direction only the amount
+    {
+        const auto band = parsed("db0.5h0.2");
+        int direction = 0;
+        check(band.passes(10, 9.4, direction) && direction == -1, "No hysteresis before the first change");
+        direction = 0;
+        check(band.passes(10, 11, direction) && direction == 1, "Rise from 10 to 11 delivered");
+        check(!band.passes(11, 10.4, direction) && direction == 1, "Fall of 0.6 after a rise dropped");
+        check(band.passes(11, 11.6, direction) && direction == 1, "Rise of 0.6 after a rise delivered");
+        check(band.passes(11, 10.2, direction) && direction == -1, "Fall of 0.8 after a rise delivered");
+        check(!band.passes(10.2, 10.8, direction) && direction == -1, "Rise of 0.6 after a fall dropped");
+        check(band.passes(10.2, 9.6, direction) && direction == -1, "Fall of 0.6 after a fall delivered");
+        check(band.passes(9.6, 10.35, direction) && direction == 1, "Rise of 0.75 after a fall delivered");
+    }
+    {
+        const auto band = parsed("db1%h1");
+        int direction = 1;
+        check(!band.passes(100, 98.5, direction) && band.passes(100, 97.9, direction) && direction == -1,
+            "Relative hysteresis: reversal needs 2% of 100");
+        check(band.passes(0, 0.5, direction) && direction == 1, "Relative hysteresis around 0 delivers the reversal");
+    }
+
+    // Not a number: delivered when it appears or disappears, the direction is kept
+    {
+        const auto band = parsed("db0.5h0.2");
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        int direction = 1;
+        check(band.passes(1, nan, direction) && band.passes(nan, 1, direction) && !band.passes(nan, nan, direction)
+            && direction == 1, "NaN delivered on change only");
+    }
+
+    printf("\n%d checks passed, %d failed\n", ok, ko);
+    return ko == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
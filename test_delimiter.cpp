@@ -0,0 +1,120 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Test of the streaming delimiter matcher used for the ##PNL_ACK## of the touch panels: the
+// delimiter split across reads at every offset, and partial matches that turn out to be content.
+// Usage: test_delimiter
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "Common/DelimiterMatcher.hxx"
+
+static int ok = 0; // Number of checks passed
+static int ko = 0; // Number of checks failed
+
+static void check(bool passed, const std::string& what)
+{
+    printf("%-70s %s\n", what.c_str(), passed ? "OK" : "FAILED");
+    passed ? ok++ : ko++;
+}
+
+// Feeds the stream in chunks cut at the given offsets, as the panel reads would
+static bool feedChunks(Common::DelimiterMatcher& matcher, const std::string& stream, const std::vector<size_t>& cuts, std::string& content)
+{
+    size_t from = 0;
+    std::vector<size_t> ends(cuts);
+    ends.push_back(stream.size());
+    for(size_t end : ends) {
+        if(matcher.feed(stream.data() + from, end - from, [&content](const char* data, size_t len) { content.append(data, len); })) {
+            return true;
+        }
+        from = end;
+    }
+    return false;
+}
+
+int main()
+{
+    const std::string delimiter = "##PNL_ACK##";
+    const std::string body = "line 1\n#line 2 ##PNL\n";
+    const std::string stream = body + delimiter + "trailer";
+
+    // One split anywhere in the stream, in particular inside the delimiter
+    bool splitOk = true;
+    for(size_t cut = 0; cut <= stream.size(); cut++) {
+        Common::DelimiterMatcher matcher(delimiter);
+        std::string content;
+        splitOk = feedChunks(matcher, stream, {cut}, content) && content == body && splitOk;
+    }
+    check(splitOk, "Delimiter found with the stream split at every offset");
+
+    // Two splits inside the delimiter, e.g. one byte per read
+    bool doubleSplitOk = true;
+    for(size_t first = body.size(); first <= body.size() + delimiter.size(); first++) {
+        for(size_t second = first; second <= body.size() + delimiter.size(); second++) {
+            Common::DelimiterMatcher matcher(delimiter);
+            std::string content;
+            doubleSplitOk = feedChunks(matcher, stream, {first, second}, content) && content == body && doubleSplitOk;
+        }
+    }
+    check(doubleSplitOk, "Delimiter found with two splits at every offset inside it");
+
+    std::vector<size_t> bytes;
+    for(size_t i = 1; i < stream.size(); i++) {
+        bytes.push_back(i);
+    }
+    {
+        Common::DelimiterMatcher matcher(delimiter);
+        std::string content;
+        check(feedChunks(matcher, stream, bytes, content) && content == body, "Delimiter found with one byte per read");
+    }
+
+    // Partial matches: the held back bytes are content, including when the mismatch is in a later read
+    const std::string partial = "##PNL_AC#x##PNL_A##PNL_ACK#";
+    bool partialOk = true;
+    for(size_t cut = 0; cut <= partial.size(); cut++) {
+        Common::DelimiterMatcher matcher(delimiter);
+        std::string content;
+        partialOk = !feedChunks(matcher, partial + "!", {cut}, content) && content == partial + "!" && partialOk;
+    }
+    check(partialOk, "Partial false matches handed to the sink, split at every offset");
+
+    {
+        Common::DelimiterMatcher matcher(delimiter);
+        std::string content;
+        check(feedChunks(matcher, "a###PNL_ACK##", {2}, content) && content == "a#", "Delimiter overlapping a false start (###PNL_ACK##)");
+    }
+
+    // Self-overlapping delimiter: the failure function must fall back, not restart
+    {
+        Common::DelimiterMatcher matcher("aab");
+        std::string content;
+        check(feedChunks(matcher, "xaaab", {2, 3, 4}, content) && content == "xa", "Self-overlapping delimiter (aab in xaaab, one byte per read)");
+    }
+
+    // reset() forgets a held back prefix; the matcher is reused for the next acknowledgement
+    {
+        Common::DelimiterMatcher matcher(delimiter);
+        std::string content;
+        feedChunks(matcher, "abc##PNL", {}, content);
+        matcher.reset();
+        content.clear();
+        check(feedChunks(matcher, "_ACK##" + stream, {}, content) && content == "_ACK##" + body, "reset() drops the held back prefix");
+        content.clear();
+        check(feedChunks(matcher, stream, {5}, content) && content == body, "Matcher reused after a match");
+    }
+
+    printf("\n%d checks passed, %d failed\n", ok, ko);
+    return ko == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
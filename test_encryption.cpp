@@ -0,0 +1,87 @@
+/** © Copyright 2023 CERN
+ *
+ * This software is distributed under the terms of the
+ * GNU Lesser General Public Licence version 3 (LGPL Version 3),
+ * copied verbatim in the file “LICENSE”
+ *
+ * In applying this licence, CERN does not waive the privileges
+ * and immunities granted to it by virtue of its status as an
+ * Intergovernmental Organization or submit itself to any jurisdiction.
+ *
+ **/
+
+// Known answer test of the DES engine used for the touch panel User file, followed by a
+// throughput comparison of the single block and multi-block ECB APIs.
+// Usage: test_encryption [megabytes]   (default 16)
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "RAMS7200Encryption.hxx"
+
+static int ok = 0; // Number of checks passed
+static int ko = 0; // Number of checks failed
+
+static void check(bool passed, const char* what)
+{
+    printf("%-60s %s\n", what, passed ? "OK" : "FAILED");
+    passed ? ok++ : ko++;
+}
+
+static double seconds(std::chrono::steady_clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t megabytes = argc > 1 ? strtoul(argv[1], nullptr, 10) : 16;
+    const size_t blocks = megabytes * 1024 * 1024 / 8;
+
+    check(des_test() == CRYPT_OK, "Known answer vectors (single and multi-block)");
+
+    symmetric_key skey;
+    const unsigned char key[8] = "123";
+    check(des_setup(key, 8, 0, &skey) == CRYPT_OK, "Key schedule of the User file key");
+
+    std::vector<unsigned char> pt(blocks * 8), single(blocks * 8), multi(blocks * 8);
+    srand(7200);
+    for(auto& b : pt) {
+        b = static_cast<unsigned char>(rand());
+    }
+
+    // Every block count up to 9: pairs plus an optional trailing block
+    bool sameSmall = true;
+    for(unsigned long n = 0; n <= 9 && n <= blocks; n++) {
+        for(unsigned long i = 0; i < n; i++) {
+            des_ecb_encrypt(&pt[8 * i], &single[8 * i], &skey);
+        }
+        des_ecb_encrypt_blocks(pt.data(), multi.data(), n, &skey);
+        sameSmall = sameSmall && memcmp(single.data(), multi.data(), 8 * n) == 0;
+    }
+    check(sameSmall, "Multi-block output identical for 0..9 blocks");
+
+    auto start = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < blocks; i++) {
+        des_ecb_encrypt(&pt[8 * i], &single[8 * i], &skey);
+    }
+    const double singleTime = seconds(std::chrono::steady_clock::now() - start);
+
+    start = std::chrono::steady_clock::now();
+    des_ecb_encrypt_blocks(pt.data(), multi.data(), blocks, &skey);
+    const double multiTime = seconds(std::chrono::steady_clock::now() - start);
+
+    check(single == multi, "Multi-block output identical on the benchmark data");
+
+    des_ecb_decrypt_blocks(multi.data(), multi.data(), blocks, &skey);
+    check(multi == pt, "Multi-block decryption restores the plaintext");
+
+    printf("\nECB encryption of %zu MB\n", megabytes);
+    printf("  des_ecb_encrypt per block : %8.1f MB/s\n", megabytes / singleTime);
+    printf("  des_ecb_encrypt_blocks    : %8.1f MB/s (x%.2f)\n", megabytes / multiTime, singleTime / multiTime);
+
+    printf("\n%d checks passed, %d failed\n", ok, ko);
+    return ko == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}